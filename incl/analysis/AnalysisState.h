@@ -1,12 +1,80 @@
 #pragma once
 
+#include <vector>
+
 #include "analysis/types.h"
+#include "analysis/CallGraph.h"
+#include "analysis/constants.h"
 
 namespace spero::analysis {
 
+	/*
+	 * Side table that stores a single analysis fact for every ast node, indexed by the node's id
+	 *   Each fact is kept in its own contiguous array, so passes only touch the data they need
+	 *
+	 * NOTE: Growing the table invalidates references into it, so references shouldn't be held across insertions
+	 */
+	template<class T>
+	class NodeTable {
+		std::vector<opt_t<T>> values;
+
+		public:
+			inline opt_t<T>& operator[](compiler::ast::NodeId id) {
+				if (id >= values.size()) {
+					values.resize(id + 1);
+				}
+
+				return values[id];
+			}
+			inline opt_t<T> at(compiler::ast::NodeId id) const {
+				return id < values.size() ? values[id] : std::nullopt;
+			}
+
+			inline void reset(compiler::ast::NodeId id) {
+				if (id < values.size()) {
+					values[id] = std::nullopt;
+				}
+			}
+			inline void clear() {
+				values.clear();
+			}
+	};
+
+	/*
+	 * The effects that calling a function may have, ordered from least to most restrictive (see `EffectPass`)
+	 *   PURE - doesn't observe any mutable state outside of the call
+	 *   READONLY - may read mutable state, but never writes it
+	 *   WRITES - may write mutable state
+	 *   UNKNOWN - calls code that couldn't be analyzed, so no assumptions can be made
+	 */
+	BETTER_ENUM(Effect, char, PURE, READONLY, WRITES, UNKNOWN);
+
 	struct AnalysisState {
 		SymArena arena;
+		TypeInterner types;
 		AllTypes type_list;
+		CoreTypes core;
+
+		// Analysis results for ast nodes
+		NodeTable<const Type*> type_of;			// ValExpr: the inferred type of the expression
+		NodeTable<SymIndex> scope_of;			// Block/InAssign/For: the SymTable holding the local declarations
+		NodeTable<SymIndex> def_table;			// Variable: the SymTable holding the variable's definition
+		NodeTable<SymIndex> sym_index;			// PathPart: the SymTable that the part refers to
+		NodeTable<size_t> ssa_index;			// PathPart/AssignName/Argument/VarPattern: the referenced definition within the symbol's `SsaVector`
+		NodeTable<String> fn_name;				// Function: the name that the function is bound to
+		NodeTable<ConstValue> const_of;			// ValExpr: the value of the expression, if known at compile time
+		NodeTable<Effect> effect_of;			// Function: the effects that calling the function may have
+		NodeTable<bool> in_bounds;				// ValExpr: the index is known to be within the array it indexes (see `ArrayPass`)
+		NodeTable<bool> local_array;			// Array: the array never outlives the enclosing call, so it can be stack allocated
+		NodeTable<bool> borrowed_arg;			// Argument: an array passed to the argument never outlives the call (see `ArrayPass`)
+		NodeTable<bool> fresh_result;			// Function: every value the function returns is a heap array that the caller takes ownership of
+		NodeTable<bool> owned_result;			// FnCall: the returned heap array is freed when the calling function returns
+
+		// Which functions refer to which (see `CallGraphPass`)
+		CallGraph calls;
+
+		// Tables in `arena` that were released by forgotten statements, so they can be reused by new scopes (see `VarDeclPass`)
+		std::vector<SymIndex> free_tables;
 
 		inline AnalysisState() {
 			arena.emplace_back(GLOBAL_SYM_INDEX, ScopingContext::GLOBAL);
@@ -18,6 +86,77 @@ namespace spero::analysis {
 			// TODO: Handle collisions
 			// NOTE: I'll probably handle collisions from the module standpoint (ie. before this point)
 			type_list.insert(types.begin(), types.end());
+
+			core.Int = typeNamed(string::names::Int);
+			core.Bool = typeNamed(string::names::Bool);
+			core.Float = typeNamed(string::names::Float);
+			core.Char = typeNamed(string::names::Char);
+			core.Byte = typeNamed(string::names::Byte);
+			core.String = typeNamed(string::names::String);
+		}
+
+		// Returns `nullptr` if no type is registered under the name
+		inline const Type* typeNamed(const String& name) const {
+			auto iter = type_list.find(name);
+			return iter != type_list.end() ? iter->second : nullptr;
+		}
+
+		// Drop every fact about a single node (ie. before the statement it belongs to is analyzed again)
+		//   Its function is also dropped from the call graph, the graph's components have to be recomputed afterwards
+		inline void forgetNode(compiler::ast::NodeId id) {
+			type_of.reset(id);
+			scope_of.reset(id);
+			def_table.reset(id);
+			sym_index.reset(id);
+			ssa_index.reset(id);
+			fn_name.reset(id);
+			const_of.reset(id);
+			effect_of.reset(id);
+			in_bounds.reset(id);
+			local_array.reset(id);
+			borrowed_arg.reset(id);
+			fresh_result.reset(id);
+			owned_result.reset(id);
+			calls.forget(id);
+		}
+
+		// Empty a table that nothing refers to anymore and mark it for reuse
+		inline void releaseTable(SymIndex table) {
+			arena[table] = SymTable{ table };
+			free_tables.push_back(table);
+		}
+
+		// Drop every fact about ast nodes, once the nodes have been freed (ie. between repl inputs)
+		//   Symbols outlive the statements that declared them, so they only forget their definitions
+		inline void forgetNodes() {
+			type_of.clear();
+			scope_of.clear();
+			def_table.clear();
+			sym_index.clear();
+			ssa_index.clear();
+			fn_name.clear();
+			const_of.clear();
+			effect_of.clear();
+			in_bounds.clear();
+			local_array.clear();
+			borrowed_arg.clear();
+			fresh_result.clear();
+			owned_result.clear();
+			calls = CallGraph{};
+
+			for (auto& table : arena) {
+				table.forEachDefinition([](SymbolInfo& info) { info.definition = nullptr; });
+			}
+		}
+
+		// Drop every fact and symbol, so the program can be analyzed from scratch
+		//   Interned types don't depend on the program, so they're kept
+		inline void forgetProgram() {
+			forgetNodes();
+
+			arena.clear();
+			arena.emplace_back(GLOBAL_SYM_INDEX, ScopingContext::GLOBAL);
+			free_tables.clear();
 		}
 
 	};
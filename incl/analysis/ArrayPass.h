@@ -0,0 +1,166 @@
+#pragma once
+
+#include <map>
+#include <set>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "parser/AstVisitor.h"
+#include "interface/CompilationState.h"
+#include "analysis/AnalysisState.h"
+
+namespace spero::analysis {
+
+	/*
+	 * Ast pass that determines how arrays can be stored and accessed
+	 *   An index is in bounds if it's a constant within the array's length, or a loop counter that the enclosing `while` test keeps within it
+	 *     Counters are mutable locals that only ever start at a non-negative constant and are incremented by non-negative constants
+	 *     The test holds from the start of the loop body until the counter is assigned (or an inner loop that assigns it is entered)
+	 *   Statements annotated with `@unchecked` opt out of bounds checking entirely
+	 *   `for` loops over an array stay within its length by construction, so they need no checks
+	 *   Array literals that are only ever indexed within the function that creates them don't outlive the call
+	 *     Neither do arrays passed to arguments that the callee only borrows (ie. indexes, iterates over or lends on in turn)
+	 *   A function whose every return value is a heap array it created hands ownership of the array to its caller
+	 *     Callers that don't let the array outlive their own call free it when they return (see `LlvmIrGenerator::ownArray`)
+	 *   The results are stored in `AnalysisState::in_bounds`, `AnalysisState::local_array`, `AnalysisState::borrowed_arg`,
+	 *     `AnalysisState::fresh_result` and `AnalysisState::owned_result`
+	 *
+	 * NOTE: Only the lengths of array literals bound to immutable names are known
+	 * NOTE: This pass relies on `VarRefPass` having resolved the definition of every variable and on `ConstFoldingPass` having run
+	 */
+	class ArrayPass : public compiler::ast::AstVisitor {
+		compiler::CompilationState& state;
+		analysis::AnalysisState& dictionary;
+
+		// Identify a binding independently of the ast node that introduced it
+		using Binding = std::tuple<SymIndex, String, size_t>;
+
+		// How an array is used, apart from being indexed or iterated over by the function that created it
+		struct Uses {
+			bool escapes = false;
+			bool returned = false;
+			std::vector<compiler::ast::NodeId> lent;	// The arguments of known functions that the array is passed to
+		};
+
+		// An array literal, or a call to a known function that may return a heap array
+		struct Source {
+			compiler::ast::NodeId node;
+			opt_t<compiler::ast::NodeId> callee;
+			opt_t<compiler::ast::NodeId> fn;
+			bool constant = false;
+			Uses uses;
+		};
+
+		// Immutable bindings of array values, the length is only known for literals
+		struct ArrayBinding {
+			Source source;
+			opt_t<size_t> length;
+		};
+
+		// Arguments of the functions that are visited
+		struct Param {
+			compiler::ast::NodeId arg;
+			compiler::ast::NodeId fn;
+			Uses uses;
+		};
+
+		// Mutable locals that may be used to count through an array
+		struct Counter {
+			compiler::ast::NodeId fn;
+			bool monotonic = true;
+		};
+
+		// A `while` test that keeps a counter below `bound`, for as long as the counter isn't assigned
+		struct Guard {
+			Binding counter;
+			int64_t bound;
+			size_t depth;
+			bool valid = true;
+		};
+
+		// An index that is in bounds if its counter turns out to be monotonic and isn't assigned by any of the `loops`
+		struct CountedAccess {
+			compiler::ast::NodeId index;
+			Binding counter;
+			std::vector<compiler::ast::NodeId> loops;
+		};
+
+		std::map<Binding, ArrayBinding> arrays;
+		std::map<Binding, Param> params;
+		std::map<Binding, Counter> counters;
+		std::vector<CountedAccess> accesses;
+		std::unordered_map<compiler::ast::NodeId, Source> sources;
+
+		// Functions that were visited, and those that may return something other than a heap array they created
+		std::vector<compiler::ast::NodeId> visited_fns;
+		std::unordered_set<compiler::ast::NodeId> returns_other;
+
+		// The state of the function currently being visited, the loops are innermost last
+		std::vector<compiler::ast::NodeId> functions;
+		std::vector<compiler::ast::NodeId> loops;
+		std::vector<Guard> guards;
+		std::unordered_map<compiler::ast::NodeId, std::set<Binding>> loop_writes;
+
+		SymIndex current = GLOBAL_SYM_INDEX;
+		size_t unchecked = 0;
+
+		// The block whose last value is returned from the current function
+		opt_t<compiler::ast::NodeId> result_block;
+
+		opt_t<Binding> bindingOf(compiler::ast::Variable& var);
+		opt_t<compiler::ast::NodeId> currentFunction() const;
+		compiler::ast::Function* calleeOf(compiler::ast::FnCall& call);
+
+		// Visit a value whose use is decided by the caller, returning the uses of the array it is (if it can be tracked)
+		Uses* visitUse(compiler::ast::ValExpr& expr);
+
+		// Visit a value that is passed to the argument of a known function, or that is returned from the current function
+		void visitLent(compiler::ast::ValExpr& expr, compiler::ast::NodeId arg);
+		void visitReturned(compiler::ast::ValExpr& expr);
+
+		// Record the guards that hold while the `while` test is true
+		void addGuards(compiler::ast::ValExpr& test);
+
+		// Record an assignment to the binding, `increment` is whether it's of the form `x = x + n` (with `n` non-negative)
+		void assigned(const Binding& binding, bool increment);
+
+		// Decide whether the index is in bounds of the indexed array, if its length is known
+		void checkIndex(compiler::ast::ValExpr& index, opt_t<size_t> length);
+
+		// Visit a loop body with the loop (and the guards of its test) in scope, `test` is null for other loops
+		void visitBody(compiler::ast::Loop& loop, compiler::ast::ValExpr* test);
+
+		// Visit a statement, honouring any `@unchecked` annotation, `returned` is whether its value is returned from the function
+		void visitAnnotated(compiler::ast::Statement& stmt, bool returned = false);
+
+		public:
+			ArrayPass(compiler::CompilationState& state, AnalysisState& dict);
+
+			// Resolve the accesses that depend on how counters are assigned once every statement has been visited
+			void finalize();
+
+			// Atoms
+			virtual void visitBlock(compiler::ast::Block&) final;
+			virtual void visitFunction(compiler::ast::Function&) final;
+
+			// Names
+			virtual void visitVariable(compiler::ast::Variable&) final;
+
+			// Control
+			virtual void visitLoop(compiler::ast::Loop&) final;
+			virtual void visitWhile(compiler::ast::While&) final;
+			virtual void visitFor(compiler::ast::For&) final;
+			virtual void visitJump(compiler::ast::Jump&) final;
+
+			// Statements
+			virtual void visitVarAssign(compiler::ast::VarAssign&) final;
+
+			// Expressions
+			virtual void visitInAssign(compiler::ast::InAssign&) final;
+			virtual void visitBinOpCall(compiler::ast::BinOpCall&) final;
+			virtual void visitIndex(compiler::ast::Index&) final;
+			virtual void visitFnCall(compiler::ast::FnCall&) final;
+	};
+
+}
@@ -1,38 +1,103 @@
 #pragma once
 
+#include <unordered_map>
+
 #include "parser/AstVisitor.h"
 #include "interface/CompilationState.h"
 #include "analysis/AnalysisState.h"
+#include "analysis/TypeUnifier.h"
 
 namespace spero::analysis {
 
 	/*
-	 * Basic typing ast pass that fills in visible type information
-	 *   and performs some simplistic type checking
+	 * Typing ast pass that infers the types of expressions and symbols
+	 *   Every expression and symbol definition is given a type variable as it is visited
+	 *   The constraints between them are solved immediately with a `TypeUnifier`, so errors are reported where they arise
+	 *   The inferred types are only written to `AnalysisState::type_of` and `SymbolInfo::type` by `finalize`
 	 *
-	 * NOTE: This is just a very basic pass to get an understanding of how analysis types work
-	 *   This will definitely be changed in the future, once I have functions and modules working
-	 *   The biggest issue is in defining how passes should be allocated / ordered
+	 * NOTE: Inference is monomorphic for now (ie. a function has a single type across all of its uses)
+	 * NOTE: This pass relies on `VarRefPass` having resolved the definition of every variable
 	 */
 	class BasicTypingPass : public compiler::ast::AstVisitor {
 		compiler::CompilationState& state;
 		analysis::AnalysisState& dictionary;
 
-		SymTable* current = nullptr;
+		// Identify a symbol definition independently of where the `SymbolInfo` is stored
+		struct SymbolKey {
+			SymIndex table;
+			String name;
+			size_t ssa_index;
+
+			inline bool operator==(const SymbolKey& rhs) const {
+				return table == rhs.table && ssa_index == rhs.ssa_index && name == rhs.name;
+			}
+		};
+		struct SymbolHash {
+			inline size_t operator()(const SymbolKey& key) const {
+				return std::hash<String>{}(key.name) ^ (key.table << 16) ^ key.ssa_index;
+			}
+		};
+
+		TypeUnifier unifier;
+		NodeTable<TypeVar> exprs;
+		std::vector<compiler::ast::NodeId> typed_exprs;
+		std::unordered_map<SymbolKey, TypeVar, SymbolHash> symbols;
+
+		SymIndex current = GLOBAL_SYM_INDEX;
+
+		// Return type variables of the enclosing functions
+		std::vector<TypeVar> returns;
+
+		// Type variable accessors
+		TypeVar typeOf(compiler::ast::ValExpr& expr);
+		TypeVar typeOf(SymIndex table, const String& name, opt_t<size_t> ssa_index);
+
+		// Constraint helpers that report any contradiction at the given location
+		void unify(TypeVar lhs, TypeVar rhs, const compiler::Location& loc);
+		void bind(TypeVar var, const Type* type, const compiler::Location& loc);
+		void bindAnnotation(TypeVar var, compiler::ast::Type& annot, const compiler::Location& loc);
+		void bindPattern(compiler::ast::AssignPattern& pattern, TypeVar var, const compiler::Location& loc);
 
 		public:
 			BasicTypingPass(compiler::CompilationState& state, AnalysisState& dict);
 
+			// Write the inferred types back into the ast and symbol tables
+			void finalize();
+
 			// Atoms
 			virtual void visitInt(compiler::ast::Int&) final;
 			virtual void visitBool(compiler::ast::Bool&) final;
 			virtual void visitString(compiler::ast::String&) final;
+			virtual void visitFloat(compiler::ast::Float&) final;
+			virtual void visitChar(compiler::ast::Char&) final;
+			virtual void visitByte(compiler::ast::Byte&) final;
+			virtual void visitTuple(compiler::ast::Tuple&) final;
+			virtual void visitArray(compiler::ast::Array&) final;
+			virtual void visitBlock(compiler::ast::Block&) final;
+			virtual void visitFunction(compiler::ast::Function&) final;
 
 			// Decorations
 			virtual void visitTypeAnnotation(compiler::ast::TypeAnnotation&) final;
+			virtual void visitArgument(compiler::ast::Argument&) final;
+
+			// Control
+			virtual void visitLoop(compiler::ast::Loop&) final;
+			virtual void visitFor(compiler::ast::For&) final;
+			virtual void visitWhile(compiler::ast::While&) final;
+			virtual void visitIfBranch(compiler::ast::IfBranch&) final;
+			virtual void visitIfElse(compiler::ast::IfElse&) final;
+			virtual void visitJump(compiler::ast::Jump&) final;
 
 			// Statements
+			virtual void visitVarAssign(compiler::ast::VarAssign&) final;
+
+			// Expressions
+			virtual void visitInAssign(compiler::ast::InAssign&) final;
+			virtual void visitVariable(compiler::ast::Variable&) final;
+			virtual void visitUnOpCall(compiler::ast::UnOpCall&) final;
 			virtual void visitBinOpCall(compiler::ast::BinOpCall&) final;
+			virtual void visitIndex(compiler::ast::Index&) final;
+			virtual void visitFnCall(compiler::ast::FnCall&) final;
 	};
 
-}
\ No newline at end of file
+}
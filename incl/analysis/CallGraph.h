@@ -0,0 +1,74 @@
+#pragma once
+
+#include <limits>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "analysis/SymTable.h"
+
+namespace spero::analysis {
+
+	/*
+	 * Graph of which functions refer to which other functions
+	 *   Functions are identified by the `NodeId` of their `ast::Function`
+	 *   Any reference counts as an edge, not just direct calls, as the referenced function still has to exist
+	 *   A function also refers to every function that is defined inside of it
+	 *
+	 * Exports:
+	 *   add - register a function with the graph
+	 *   addEdge - record that one function refers to another
+	 *   addGlobalReference - record that a function is referred to outside of any function (ie. by a global)
+	 *   forget - drop a function (and the references it makes) or a global reference, by the id of its node
+	 *   computeComponents - group the functions into strongly connected components (Tarjan)
+	 *   components - the strongly connected components, callees before callers
+	 *   waves - the components grouped so that no component refers to one in the same or a later wave
+	 *   componentOf - the index of the component that contains a function
+	 *   callees - the functions that a function refers to
+	 *   reachableFrom - every function that can be reached from the given roots (and the globally referenced functions)
+	 */
+	class CallGraph {
+		std::vector<compiler::ast::NodeId> nodes;
+		std::unordered_map<compiler::ast::NodeId, size_t> node_index;
+		std::vector<std::vector<size_t>> edges;
+		std::unordered_map<compiler::ast::NodeId, size_t> global_refs;			// referring node -> function
+
+		// Forgotten functions leave their slot behind, which `add` reuses once the references to it are gone
+		static constexpr compiler::ast::NodeId removed = std::numeric_limits<compiler::ast::NodeId>::max();
+		std::vector<size_t> forgotten, free_nodes;
+
+		std::vector<std::vector<compiler::ast::NodeId>> sccs;
+		std::vector<size_t> scc_of;
+		std::vector<std::vector<size_t>> scc_waves;
+
+		public:
+			size_t add(compiler::ast::NodeId fn);
+			void addEdge(compiler::ast::NodeId caller, compiler::ast::NodeId callee);
+			void addGlobalReference(compiler::ast::NodeId ref, compiler::ast::NodeId callee);
+
+			// References to a forgotten function are dropped by the next `computeComponents`
+			void forget(compiler::ast::NodeId id);
+
+			// Must be called after the last edge is added for the component accessors to be valid
+			void computeComponents();
+
+			inline const std::vector<std::vector<compiler::ast::NodeId>>& components() const {
+				return sccs;
+			}
+			inline const std::vector<std::vector<size_t>>& waves() const {
+				return scc_waves;
+			}
+			opt_t<size_t> componentOf(compiler::ast::NodeId fn) const;
+			std::vector<compiler::ast::NodeId> callees(compiler::ast::NodeId fn) const;
+
+			// Whether the component contains a cycle (ie. a recursive function)
+			bool isRecursive(size_t component) const;
+
+			std::unordered_set<compiler::ast::NodeId> reachableFrom(const std::vector<compiler::ast::NodeId>& roots) const;
+
+			inline size_t size() const {
+				return node_index.size();
+			}
+	};
+
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "parser/AstVisitor.h"
+#include "analysis/AnalysisState.h"
+
+namespace spero::analysis {
+
+	/*
+	 * Ast pass that builds the `CallGraph` of the program from the resolved variable references
+	 *
+	 * NOTE: This pass relies on `VarRefPass` having resolved the definition of every variable
+	 */
+	class CallGraphPass : public compiler::ast::AstVisitor {
+		analysis::AnalysisState& dictionary;
+
+		// The functions enclosing the current node, innermost last
+		std::vector<compiler::ast::NodeId> enclosing;
+
+		public:
+			CallGraphPass(AnalysisState& dict);
+
+			// Compute the components of the graph once every statement has been visited
+			void finalize();
+
+			// Atoms
+			virtual void visitFunction(compiler::ast::Function&) final;
+
+			// Names
+			virtual void visitVariable(compiler::ast::Variable&) final;
+	};
+
+}
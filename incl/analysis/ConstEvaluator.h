@@ -0,0 +1,68 @@
+#pragma once
+
+#include <map>
+#include <tuple>
+#include <unordered_map>
+
+#include "parser/ast.h"
+#include "analysis/AnalysisState.h"
+
+namespace spero::analysis {
+
+	/*
+	 * Bounded interpreter that evaluates calls to functions at compile time
+	 *   Only pure code can be evaluated. Anything the interpreter doesn't understand (or can't prove has no effects) aborts the evaluation
+	 *   In particular, only locals of the evaluated calls can be assigned to and only constant globals (see `ConstFoldingPass`) can be read
+	 *   Evaluations are limited in the number of steps, call depth and number of live bindings, so a call that doesn't terminate just isn't evaluated
+	 *
+	 * NOTE: Only calls to global functions are evaluated, as the arguments of nested functions are declared in the enclosing scope
+	 *
+	 * Exports:
+	 *   call - evaluate the function with the given arguments, returning `std::nullopt` if the result can't be computed
+	 */
+	class ConstEvaluator {
+		static constexpr size_t max_steps = 1 << 20;
+		static constexpr size_t max_depth = 256;
+		static constexpr size_t max_bindings = 1 << 16;
+
+		analysis::AnalysisState& dictionary;
+
+		// Identify a binding independently of the ast node that introduced it
+		using Binding = std::tuple<SymIndex, String, size_t>;
+		struct BindingHash {
+			inline size_t operator()(const Binding& b) const {
+				return std::hash<String>{}(std::get<1>(b)) ^ (std::get<0>(b) << 16) ^ std::get<2>(b);
+			}
+		};
+		using Frame = std::unordered_map<Binding, ConstValue, BindingHash>;
+
+		// The results of every evaluated call, including the calls that couldn't be evaluated (as `std::nullopt`)
+		std::map<std::pair<compiler::ast::NodeId, std::vector<ConstValue>>, opt_t<ConstValue>> results;
+
+		// State of the current evaluation
+		std::vector<Frame> frames;
+		SymIndex current = GLOBAL_SYM_INDEX;
+		size_t steps = 0;
+		size_t bindings = 0;
+		bool failed = false;
+
+		opt_t<ConstValue> eval(compiler::ast::Ast& node);
+		opt_t<ConstValue> evalCall(compiler::ast::Function& fn, const std::vector<ConstValue>& args);
+
+		// Binding helpers, these fail the evaluation if the binding can't be resolved
+		opt_t<Binding> bindingOf(compiler::ast::Variable& var);
+		bool bind(const Binding& binding, ConstValue value);
+
+		// Abort the current evaluation, always returns `std::nullopt` for convenience
+		opt_t<ConstValue> fail();
+
+		public:
+			ConstEvaluator(AnalysisState& dict);
+
+			opt_t<ConstValue> call(compiler::ast::Function& fn, const std::vector<ConstValue>& args);
+
+			// Find the global function that the callee of a call refers to, if it's one
+			compiler::ast::Function* globalFunction(compiler::ast::ValExpr& callee);
+	};
+
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <unordered_set>
+
+#include "parser/AstVisitor.h"
+#include "analysis/AnalysisState.h"
+#include "analysis/ConstEvaluator.h"
+
+namespace spero::analysis {
+
+	/*
+	 * Ast pass that computes the value of every expression that is known at compile time
+	 *   Literals, builtin operators over constants and uses of immutable bindings to constants are folded
+	 *   Calls to global functions with constant arguments are evaluated by a `ConstEvaluator`, if the function is pure
+	 *   The values are stored in `AnalysisState::const_of`, so code generation can emit them directly
+	 *
+	 * NOTE: This pass relies on `VarRefPass` having resolved the definition of every variable
+	 * NOTE: The bindings of mutable variables are never folded, even if they are never reassigned
+	 */
+	class ConstFoldingPass : public compiler::ast::AstVisitor {
+		analysis::AnalysisState& dictionary;
+
+		// Definitions that have already been evaluated (or are being evaluated) on demand
+		// Needed as a variable may be used before the pass reaches its definition (ie. globals)
+		std::unordered_set<compiler::ast::NodeId> evaluated;
+
+		ConstEvaluator evaluator;
+
+		public:
+			ConstFoldingPass(AnalysisState& dict);
+
+			// Literals
+			virtual void visitBool(compiler::ast::Bool&) final;
+			virtual void visitFloat(compiler::ast::Float&) final;
+			virtual void visitInt(compiler::ast::Int&) final;
+			virtual void visitChar(compiler::ast::Char&) final;
+
+			// Atoms
+			virtual void visitTuple(compiler::ast::Tuple&) final;
+
+			// Names
+			virtual void visitVariable(compiler::ast::Variable&) final;
+
+			// Decorations
+			virtual void visitTypeAnnotation(compiler::ast::TypeAnnotation&) final;
+
+			// Expressions
+			virtual void visitUnOpCall(compiler::ast::UnOpCall&) final;
+			virtual void visitBinOpCall(compiler::ast::BinOpCall&) final;
+			virtual void visitFnCall(compiler::ast::FnCall&) final;
+	};
+
+}
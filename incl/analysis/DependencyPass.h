@@ -0,0 +1,53 @@
+#pragma once
+
+#include <unordered_set>
+
+#include "parser/AstVisitor.h"
+
+namespace spero::analysis {
+
+	/*
+	 * Ast pass that collects the global names a top-level statement declares and depends on
+	 *   Used by the streaming pipeline to hold a statement back from codegen until everything it uses is emitted
+	 *   And by incremental compiles to find the statements that an edit affects (see `ProgramQueries`)
+	 *
+	 * NOTE: This is a purely syntactic approximation (shadowing is resolved by ignoring every locally declared name)
+	 *
+	 * Exports:
+	 *   declared - names that the statement binds in the global scope
+	 *   required - names that the statement uses but does not declare itself
+	 *   arguments - names of the arguments of top-level functions (`VarDeclPass` binds these in the global table)
+	 */
+	class DependencyPass : public compiler::ast::AstVisitor {
+		size_t depth = 0;
+		std::unordered_set<String> locals;
+		std::unordered_set<String> used;
+
+		public:
+			std::unordered_set<String> declared;
+			std::unordered_set<String> required;
+			std::unordered_set<String> arguments;
+
+			// Run the pass over the given statement, filling `declared`, `required` and `arguments`
+			void collect(compiler::ast::Ast& stmt);
+
+			// Decorations
+			virtual void visitArgument(compiler::ast::Argument&) final;
+
+			// Atoms
+			virtual void visitBlock(compiler::ast::Block&) final;
+			virtual void visitFunction(compiler::ast::Function&) final;
+
+			// Control
+			virtual void visitFor(compiler::ast::For&) final;
+
+			// Names
+			virtual void visitVariable(compiler::ast::Variable&) final;
+			virtual void visitAssignName(compiler::ast::AssignName&) final;
+
+			// Statements
+			virtual void visitInAssign(compiler::ast::InAssign&) final;
+			virtual void visitTypeAssign(compiler::ast::TypeAssign&) final;
+	};
+
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <set>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "parser/AstVisitor.h"
+#include "analysis/AnalysisState.h"
+
+namespace spero::analysis {
+
+	/*
+	 * Ast pass that classifies every function by the effects that calling it may have
+	 *   A function's own effects come from reading or assigning mutable bindings that it doesn't own (ie. globals, captures)
+	 *   Calls to functions that can't be resolved (ie. to an argument) are assumed to do anything
+	 *   Indexing reads the array's memory, which may have been passed in by the caller
+	 *   Arrays that outlive the call are allocated on the heap, which is a write that llvm can see
+	 *   The effects are then propagated through the `CallGraph`, callees first, so a function is never "purer" than what it calls
+	 *   The results are stored in `AnalysisState::effect_of`
+	 *
+	 * NOTE: This pass relies on `VarRefPass` having resolved the definition of every variable, on `CallGraphPass` having built the graph
+	 *   and on `ArrayPass` having decided which arrays are kept on the stack
+	 */
+	class EffectPass : public compiler::ast::AstVisitor {
+		analysis::AnalysisState& dictionary;
+
+		// Identify a binding independently of the ast node that introduced it
+		using Binding = std::tuple<SymIndex, String, size_t>;
+
+		// The bindings that are owned by a function, so they can't be observed by its callers
+		struct FunctionScope {
+			compiler::ast::NodeId fn;
+			std::unordered_set<SymIndex> tables;
+			std::set<Binding> args;
+			Effect effect = Effect::PURE;
+		};
+
+		// The functions enclosing the current node, innermost last
+		std::vector<FunctionScope> enclosing;
+		std::unordered_map<compiler::ast::NodeId, Effect> local_effects;
+		SymIndex current = GLOBAL_SYM_INDEX;
+
+		// Raise the effect of the innermost function, if there is one
+		void addEffect(Effect effect);
+
+		// Whether the variable refers to a binding owned by the innermost function
+		bool isLocal(compiler::ast::Variable& var);
+
+		// Returns `nullptr` if the variable doesn't refer to a resolved symbol
+		SymbolInfo* symbolOf(compiler::ast::Variable& var);
+
+		template<class Fn>
+		void withScope(opt_t<SymIndex> scope, Fn&& visit) {
+			auto parent_scope = current;
+			current = scope ? *scope : current;
+
+			// Scopes without declarations share the table of their parent
+			if (current != parent_scope && !enclosing.empty()) {
+				enclosing.back().tables.insert(current);
+			}
+
+			visit();
+			current = parent_scope;
+		}
+
+		public:
+			EffectPass(AnalysisState& dict);
+
+			// Propagate the effects through the call graph once every statement has been visited
+			//   Only the components of the visited functions are classified, so statements may be analyzed in batches
+			void finalize();
+
+			// Atoms
+			virtual void visitArray(compiler::ast::Array&) final;
+			virtual void visitFunction(compiler::ast::Function&) final;
+
+			// Names
+			virtual void visitVariable(compiler::ast::Variable&) final;
+
+			// Expressions
+			virtual void visitBlock(compiler::ast::Block&) final;
+			virtual void visitBinOpCall(compiler::ast::BinOpCall&) final;
+			virtual void visitFnCall(compiler::ast::FnCall&) final;
+			virtual void visitFor(compiler::ast::For&) final;
+			virtual void visitIndex(compiler::ast::Index&) final;
+			virtual void visitInAssign(compiler::ast::InAssign&) final;
+	};
+
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <unordered_map>
+#include <unordered_set>
+#include <variant>
+
+#include "analysis/QueryEngine.h"
+#include "analysis/SymTable.h"
+
+namespace spero::analysis {
+
+	/*
+	 * Queries over the top-level statements of a program
+	 *   Statements are identified by their `NodeId`. Editing a statement replaces its node, so the facts for an id never go stale
+	 *   This lets an edit only invalidate the facts of the statements it replaced (and anything that reads them)
+	 *
+	 * NOTE: The driver keeps the inputs in sync with its ast (see `AnalysisDriver::updateProgramQueries`)
+	 *   The names of a statement are collected once, when its node is first seen, so the engine never holds on to the ast
+	 *
+	 * Exports:
+	 *   ProgramStatements - (input) the top-level statements, in source order
+	 *   StatementNames - (input) the global names that a statement declares, uses, and binds as arguments
+	 *   GlobalDeclarations - the statements that declare every global name, in source order
+	 *   GlobalUses - the statements that use every global name, in source order
+	 */
+	struct ProgramStatements {
+		using Key = std::monostate;
+		using Value = std::vector<compiler::ast::NodeId>;
+	};
+
+	struct StatementNames {
+		using Key = compiler::ast::NodeId;
+		struct Value {
+			std::unordered_set<String> declared;
+			std::unordered_set<String> required;
+			std::unordered_set<String> arguments;
+
+			inline bool operator==(const Value& rhs) const {
+				return declared == rhs.declared && required == rhs.required && arguments == rhs.arguments;
+			}
+		};
+	};
+
+	struct GlobalDeclarations {
+		using Key = std::monostate;
+		using Value = std::unordered_map<String, std::vector<compiler::ast::NodeId>>;
+
+		static Value compute(QueryEngine& engine, const Key&);
+	};
+
+	struct GlobalUses {
+		using Key = std::monostate;
+		using Value = std::unordered_map<String, std::vector<compiler::ast::NodeId>>;
+
+		static Value compute(QueryEngine& engine, const Key&);
+	};
+
+}
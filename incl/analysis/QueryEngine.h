@@ -0,0 +1,175 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+namespace spero::analysis {
+
+	using Revision = uint64_t;
+
+	// Inputs are exactly the queries that don't define `compute`
+	template<class Q, class = void>
+	struct is_input_query : std::true_type {};
+	template<class Q>
+	struct is_input_query<Q, std::void_t<decltype(&Q::compute)>> : std::false_type {};
+
+	/*
+	 * Memoizing engine for incremental compilation (in the style of rustc's queries)
+	 *   Every fact is computed by a query that is only run when its result is requested
+	 *   A query records every other query that it reads, and its result is reused until one of those changes
+	 *   Inputs are the only values that are set directly. Changing (or removing) an input starts a new revision
+	 *
+	 * A query is described by a type with the following members:
+	 *   Key - identifies an instance of the query (must be hashable with `std::hash`)
+	 *   Value - the computed fact (must be equality comparable, so a recomputed but unchanged result doesn't invalidate its readers)
+	 *   static Value compute(QueryEngine&, const Key&) - how to compute the fact (not needed for inputs)
+	 *
+	 * NOTE: A query that requests itself (indirectly) receives its last value (or a default constructed `Value`) and `cycle` is set
+	 * NOTE: Inputs must not be set or removed while a query is being computed
+	 *
+	 * Exports:
+	 *   set - change the value of an input query
+	 *   remove - drop an input query, so its memo doesn't outlive the thing it describes
+	 *   get - request the value of a query, recomputing it only if something it read has changed
+	 *   revision - the current revision of the engine
+	 */
+	class QueryEngine {
+		struct Memo {
+			Revision verified_at = 0;			// Last revision the value was known to be up to date
+			Revision changed_at = 0;			// Last revision the value actually changed
+			bool has_value = false;
+			bool is_input = false;
+			bool active = false;
+			std::vector<Memo*> deps;
+
+			virtual ~Memo() = default;
+
+			// Recompute the value, returning whether it differs from the old value
+			virtual bool recompute(QueryEngine&) = 0;
+		};
+
+		template<class Q>
+		struct QueryMemo : Memo {
+			typename Q::Key key;
+			typename Q::Value value{};
+
+			QueryMemo(const typename Q::Key& key) : key{ key } {}
+
+			virtual bool recompute(QueryEngine& engine) final {
+				if constexpr (is_input_query<Q>::value) {
+					return false;
+
+				} else {
+					auto result = Q::compute(engine, key);
+					if (has_value && result == value) {
+						return false;
+					}
+
+					value = std::move(result);
+					return true;
+				}
+			}
+		};
+
+		struct StorageBase {
+			virtual ~StorageBase() = default;
+
+			// Visit every memo in the storage
+			virtual void forEach(void (*fn)(Memo&, const Memo*), const Memo* arg) = 0;
+		};
+
+		// NOTE: `unordered_map` never moves its elements, so memos can point to each other
+		template<class Q>
+		struct Storage : StorageBase {
+			std::unordered_map<typename Q::Key, QueryMemo<Q>> memos;
+
+			virtual void forEach(void (*fn)(Memo&, const Memo*), const Memo* arg) final {
+				for (auto&[key, memo] : memos) {
+					fn(memo, arg);
+				}
+			}
+		};
+
+		std::unordered_map<std::type_index, std::unique_ptr<StorageBase>> storages;
+		std::vector<Memo*> active;
+		Revision current = 1;
+
+		template<class Q>
+		QueryMemo<Q>& memoFor(const typename Q::Key& key) {
+			auto& storage = storages[typeid(Q)];
+			if (!storage) {
+				storage = std::make_unique<Storage<Q>>();
+			}
+
+			return static_cast<Storage<Q>&>(*storage).memos.try_emplace(key, key).first->second;
+		}
+
+		// Bring the memo up to date with the current revision
+		void refresh(Memo& memo);
+
+		// Make every query that read the memo compute its value from scratch, as the memo is about to be freed
+		void detach(const Memo& memo);
+
+		public:
+			bool cycle = false;
+
+			QueryEngine() = default;
+			QueryEngine(const QueryEngine&) = delete;
+
+			template<class Q>
+			void set(const typename Q::Key& key, typename Q::Value value) {
+				auto& memo = memoFor<Q>(key);
+				memo.is_input = true;
+
+				if (memo.has_value && memo.value == value) {
+					return;
+				}
+
+				memo.value = std::move(value);
+				memo.has_value = true;
+				memo.changed_at = memo.verified_at = ++current;
+			}
+
+			template<class Q>
+			void remove(const typename Q::Key& key) {
+				static_assert(is_input_query<Q>::value, "Only inputs can be removed");
+
+				auto storage = storages.find(typeid(Q));
+				if (storage == storages.end()) {
+					return;
+				}
+
+				auto& memos = static_cast<Storage<Q>&>(*storage->second).memos;
+				if (auto iter = memos.find(key); iter != memos.end()) {
+					detach(iter->second);
+					memos.erase(iter);
+					++current;
+				}
+			}
+
+			template<class Q>
+			const typename Q::Value& get(const typename Q::Key& key) {
+				auto& memo = memoFor<Q>(key);
+				if (!active.empty()) {
+					active.back()->deps.push_back(&memo);
+				}
+
+				if (memo.active) {
+					cycle = true;
+				} else {
+					refresh(memo);
+				}
+
+				return memo.value;
+			}
+
+			inline Revision revision() const {
+				return current;
+			}
+	};
+
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <functional>
+
+#include "parser/AstVisitor.h"
+
+namespace spero::analysis {
+
+	/*
+	 * Ast pass that calls a function on every node of a subtree, parents before their children
+	 *   Used by incremental compiles to shift reused statements and to forget the facts of replaced ones
+	 *
+	 * NOTE: Only the root visits (those that don't forward to another visit) need to be overridden
+	 */
+	class SubtreePass : public compiler::ast::AstVisitor {
+		std::function<void(compiler::ast::Ast&)> fn;
+
+		public:
+			SubtreePass(std::function<void(compiler::ast::Ast&)> fn);
+
+			// Base Nodes
+			virtual void visitAst(compiler::ast::Ast&) final;
+			virtual void visitToken(compiler::ast::Token&) final;
+			virtual void visitStatement(compiler::ast::Statement&) final;
+
+			// Names
+			virtual void visitBasicBinding(compiler::ast::BasicBinding&) final;
+			virtual void visitPathPart(compiler::ast::PathPart&) final;
+			virtual void visitPath(compiler::ast::Path&) final;
+			virtual void visitPattern(compiler::ast::Pattern&) final;
+			virtual void visitAssignPattern(compiler::ast::AssignPattern&) final;
+
+			// Types
+			virtual void visitType(compiler::ast::Type&) final;
+
+			// Decorations
+			virtual void visitAnnotation(compiler::ast::Annotation&) final;
+			virtual void visitGenericPart(compiler::ast::GenericPart&) final;
+			virtual void visitGenericArray(compiler::ast::GenericArray&) final;
+			virtual void visitConstructor(compiler::ast::Constructor&) final;
+			virtual void visitArgument(compiler::ast::Argument&) final;
+	};
+
+}
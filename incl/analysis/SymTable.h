@@ -5,6 +5,7 @@
 #include <set>
 #include <unordered_map>
 #include <variant>
+#include <vector>
 
 #include <enum.h>
 
@@ -17,6 +18,7 @@ using ref_t = std::reference_wrapper<T>;
 //TODO: Create `opt_ref` struct to wrap 'ref_t' in 'opt_t' ???
 
 namespace llvm {
+	class Type;
 	class Value;
 }
 
@@ -47,21 +49,27 @@ namespace spero::analysis {
 		opt_t<SymIndex> type_def_index = std::nullopt;
 
 		// The symbol's inferred type scheme
-		std::shared_ptr<Type> type = nullptr;
+		const Type* type = nullptr;
 
 		// TODO: Not sure if we should have this
+		// NOTE: Reset to `nullptr` once the defining statement is freed (see `AnalysisState::forgetNodes`)
 		compiler::ast::Ast* definition = nullptr;
 
 		// Llvm allocated storage location
 		llvm::Value* storage = nullptr;
+
+		// The type of the value held in `storage` if it's a slot (ie. an alloca or global) that has to be loaded from
+		// NOTE: `nullptr` when `storage` is the ssa value itself (ie. immutable locals and arguments)
+		llvm::Type* slot_type = nullptr;
 		// TODO: How would types be handled? 
 	};
 
 	/*
 	 * Collect all definitions for a single symbol name under a unified group for some analysis steps
 	 *   This structure performs the dual roles of ssa name resolution function overloading
+	 *   Definitions are indexed by the `ssa_index` assigned when they're declared (see `VarDeclPass`)
 	 */
-	struct SsaVector : std::deque<SymbolInfo> {
+	struct SsaVector : std::vector<SymbolInfo> {
 		bool is_overload_set;
 	};
 
@@ -114,6 +122,18 @@ namespace spero::analysis {
 			// Visibility interfaces
 			bool exported();
 			void markExported();
+
+			// Visit every definition stored under the name
+			template<class Fn>
+			void forEachDefinition(Fn&& fn) {
+				for (auto&[index, data] : instances) {
+					if (auto* defs = std::get_if<SsaVector>(&data)) {
+						for (auto& info : *defs) {
+							fn(info);
+						}
+					}
+				}
+			}
 	};
 	
 
@@ -148,7 +168,8 @@ namespace spero::analysis {
 
 			// Accessor interfaces
 			opt_t<ref_t<GenericResolver>> get(const String& key);
-			opt_t<SymbolTypes> get(const String& key, GenericInstanceIndexType index, compiler::Location loc, opt_t<size_t>& ssa_index);
+			opt_t<SymbolTypes> get(const String& key, GenericInstanceIndexType index, opt_t<size_t>& ssa_index);
+			size_t numDefinitions(const String& key);
 
  			// Mutation interfaces
 			bool insert(const String& key, SymbolInfo value, bool exported = false);
@@ -156,6 +177,9 @@ namespace spero::analysis {
 			bool insertArg(const String& key, SymbolInfo value);
 			bool insertArg(const String& key, GenericResolver::SymbolInputTypes value);
 
+			// Drop every definition under the name (ie. before the statements that declared it are analyzed again)
+			void erase(const String& key);
+
 			// Analysis interfaces
 			SymIndex self() const;
 			void setParent(SymIndex p);
@@ -163,6 +187,14 @@ namespace spero::analysis {
 			ScopingContext context() const;
 			SymTable* mostRecentDef(const String& key, std::deque<SymTable>& arena);
 
+			// Visit every definition stored in this table
+			template<class Fn>
+			void forEachDefinition(Fn&& fn) {
+				for (auto&[key, resolver] : symbols) {
+					resolver.forEachDefinition(fn);
+				}
+			}
+
 			// Counting interfaces
 			inline const auto begin() const {
 				return symbols.cbegin();
@@ -185,4 +217,23 @@ namespace spero::analysis {
 		return std::distance(front, end);
 	}
 
+
+	/*
+	 * Tracks the innermost table that binds each name at the current point of an ast traversal
+	 *   Tables are pushed as their scopes are entered and popped as they are left,
+	 *   Turning the `mostRecentDef` walk up the parent chain into a single hash lookup
+	 *
+	 * NOTE: The global table isn't tracked as it gains symbols between traversals (ie. in the repl)
+	 *   Names that aren't bound in any entered scope fall back to the global table
+	 */
+	class ScopedNames {
+		std::unordered_map<String, std::vector<SymIndex>> bindings;
+
+		public:
+			void enter(const SymArena& arena, SymIndex table);
+			void leave(const SymArena& arena, SymIndex table);
+
+			SymTable* mostRecentDef(const String& key, SymArena& arena) const;
+	};
+
 }
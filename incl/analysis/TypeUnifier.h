@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "analysis/types.h"
+
+namespace spero::analysis {
+
+	using TypeVar = uint32_t;
+
+	/*
+	 * Union-find structure over type variables for constraint based type inference
+	 *   Every equivalence class may be bound to a concrete type, or shaped as a structured type over other variables (ie. a function)
+	 *   Classes are merged by rank and paths are compressed on `find`, so solving is near-linear in the number of constraints
+	 *
+	 * Exports:
+	 *   fresh - create a new, unconstrained type variable
+	 *   function - create a type variable for a function over the given argument/return variables
+	 *   array - create a type variable for an array of the given element variable
+	 *   tuple - create a type variable for a tuple of the given element variables
+	 *   known - create a type variable for an already resolved type (a fresh variable if it's `nullptr`)
+	 *   unify - constrain two variables to have the same type
+	 *   bind - constrain a variable to have a specific concrete type
+	 *   resolve - compute the concrete type of a variable, if it has been determined
+	 */
+	class TypeUnifier {
+		struct Class {
+			TypeVar parent;
+			uint32_t rank = 0;
+			const Type* bound = nullptr;
+
+			// Structured classes are described by the variables of their components (see `Type::parts`)
+			opt_t<TypeKind> shape;
+			std::vector<TypeVar> parts;
+		};
+
+		std::vector<Class> classes;
+		std::pair<const Type*, const Type*> last_conflict;
+
+		TypeVar structured(TypeKind kind, std::vector<TypeVar> parts);
+
+		public:
+			TypeVar fresh();
+			TypeVar function(std::vector<TypeVar> args, TypeVar ret);
+			TypeVar array(TypeVar elem);
+			TypeVar tuple(std::vector<TypeVar> elems);
+			TypeVar known(const Type* type);
+			TypeVar find(TypeVar var);
+
+			// These return false if the constraint contradicts what's already known
+			// The variables are still merged, so later constraints don't report the same error again
+			bool unify(TypeVar lhs, TypeVar rhs);
+			bool bind(TypeVar var, const Type* type);
+
+			// Returns `nullptr` if the type isn't (fully) determined
+			const Type* resolve(TypeVar var, TypeInterner& types);
+
+			// The concrete types involved in the last failed constraint (either may be `nullptr`)
+			inline std::pair<const Type*, const Type*> conflict() const {
+				return last_conflict;
+			}
+	};
+
+}
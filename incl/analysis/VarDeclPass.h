@@ -10,6 +10,7 @@ namespace spero::analysis {
 	 * Ast pass that collects all symbol declarations and introductions (where is it defined)
 	 *
 	 * NOTE: This pass is run before `VarRefPass` and creates all of the symbol tables
+	 * NOTE: Scopes without any declarations are not given a table, their `SymIndex` is that of the enclosing table
 	 */
 	class VarDeclPass : public compiler::ast::AstVisitor {
 		compiler::CompilationState& state;
@@ -28,6 +29,9 @@ namespace spero::analysis {
 		// TEMPORARY declarations
 		compiler::ast::Interface* current_decl;
 
+		// Create the SymTable for a new scope, if it needs one
+		SymIndex openScope(bool needs_table);
+
 		public:
 			VarDeclPass(compiler::CompilationState& state, AnalysisState& dict);
 
@@ -56,6 +60,7 @@ namespace spero::analysis {
 			// Control
 			// NOTE: Solution to Case::expr lack of SymTable is probably generalizable to InAssign
 			//virtual void visitCase(compiler::ast::Case&) final;
+			virtual void visitFor(compiler::ast::For&) final;
 
 			// Statements
 			virtual void visitInAssign(compiler::ast::InAssign&) final;
@@ -16,23 +16,59 @@ namespace spero::analysis {
 
 		SymIndex current = GLOBAL_SYM_INDEX;
 
+		// Names bound by the scopes enclosing the current node
+		ScopedNames visible;
+
+		// The most recent definition of every name seen so far, for each SymTable
+		// As the ast is walked in order, this is the definition that a use refers to
+		std::unordered_map<SymIndex, std::unordered_map<String, size_t>> definitions;
+
 		// Track the current scoping context to be able to tailor analysis
 		ScopingContext context = ScopingContext::GLOBAL;
+
+		// Make `scope` the current table, pushing its names if it is a new scope
+		// NOTE: Scopes without declarations share their ancestor's table, which is already visible
+		template<class Fn>
+		void withScope(SymIndex scope, Fn&& visit) {
+			auto parent_scope = current;
+			current = scope;
+
+			if (scope != parent_scope) {
+				visible.enter(dictionary.arena, scope);
+				visit();
+				visible.leave(dictionary.arena, scope);
+
+			} else {
+				visit();
+			}
+
+			current = parent_scope;
+		}
 		
 		public:
 			VarRefPass(compiler::CompilationState& state, AnalysisState& dict);
 
+			// Decorations
+			virtual void visitArgument(compiler::ast::Argument&) final;
+
 			// Atoms
 			virtual void visitBlock(compiler::ast::Block&) final;
 			virtual void visitFunction(compiler::ast::Function&) final;
 
+			// Control
+			virtual void visitFor(compiler::ast::For&) final;
+
 			// Expressions
 			virtual void visitVariable(compiler::ast::Variable&) final;
 			virtual void visitBinOpCall(compiler::ast::BinOpCall&) final;
 
+			// Names
+			virtual void visitAssignName(compiler::ast::AssignName&) final;
+
 			// Statements
 			virtual void visitInAssign(compiler::ast::InAssign&) final;
 			virtual void visitTypeAssign(compiler::ast::TypeAssign&) final;
+			virtual void visitVarAssign(compiler::ast::VarAssign&) final;
 	};
 
 }
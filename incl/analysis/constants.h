@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+#include <variant>
+
+#include "analysis/SymTable.h"
+
+namespace spero::analysis {
+
+	/*
+	 * Value of an expression that is known at compile time
+	 *   The alternatives correspond to the core types `Bool`, `Char`, `Int` and `Float`
+	 */
+	using ConstValue = std::variant<bool, char, int64_t, double>;
+
+	/*
+	 * Evaluate a builtin operator over constant operands
+	 *   These follow the semantics of the generated code, except that they fail instead of overflowing
+	 *   So `std::nullopt` is returned if the result isn't defined (ie. division by 0) or the operator isn't supported
+	 */
+	opt_t<ConstValue> evalUnary(const String& op, const ConstValue& expr);
+	opt_t<ConstValue> evalBinary(const String& op, const ConstValue& lhs, const ConstValue& rhs);
+
+}
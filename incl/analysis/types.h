@@ -1,64 +1,183 @@
 #pragma once
 
 #include <deque>
-#include <memory>
+#include <functional>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include "spero_string.h"
 #include "analysis/SymTable.h"
 
-namespace llvm {
-	class Type;
-}
-
 namespace spero::analysis {
 
 	class Type;
-	using AllTypes = std::unordered_map<String, std::shared_ptr<Type>>;
+	using AllTypes = std::unordered_map<String, const Type*>;
+
+	/*
+	 * Enum class for specifying the structure of an analysis type
+	 *   Indirections (ie. `&`, `*`) are represented as types that wrap their pointee
+	 */
+	BETTER_ENUM(TypeKind, char, NAMED, TUPLE, FUNCTION, GENERIC, ARRAY, POINTER, REFERENCE, VIEW);
 
 	/*
 	 * Base class for internal type representation
+	 *   Types are created by a `TypeInterner`, which only ever makes one instance of any structure
+	 *   This means that two types are the same iff they have the same address
+	 *
+	 * NOTE: See `type_rep_notes.h` for what the full type representation will eventually need
 	 */
 	class Type {
-		const Type* cannonical_type = this;
-		const SymTable* def = nullptr;			// This may have to be moved to a subtype (is there a type that doesn't need this - it doesn't have to use it)
-		String name;
+		friend class TypeInterner;
+
+		TypeKind type_kind;
+		String type_name;
 
-		// llvm translation helpers
-		// TODO: Needed ???
-		const llvm::Type* llvm_translation = nullptr;
+		// Component types, the meaning of which depends on the kind
+		//   TUPLE - element types
+		//   FUNCTION - argument types, followed by the return type
+		//   GENERIC - instantiation arguments
+		//   ARRAY - the element type
+		//   POINTER/REFERENCE/VIEW - the pointed to type
+		std::vector<const Type*> components;
 
 		bool is_mutable = false;
-		bool is_view = false;
-		bool is_reference = false;
-		bool is_pointer = false;
+
+		Type(TypeKind kind, String name, std::vector<const Type*> parts, bool mut)
+			: type_kind{ kind }, type_name{ name }, components{ std::move(parts) }, is_mutable{ mut } {}
 
 		public:
-			Type(String name) : name{ name } {}
-			virtual ~Type() {}
+			Type(Type&&) = default;
+			Type(const Type&) = delete;
+
+			inline TypeKind kind() const {
+				return type_kind;
+			}
+			inline const String& name() const {
+				return type_name;
+			}
+			inline const std::vector<const Type*>& parts() const {
+				return components;
+			}
+			inline bool isMutable() const {
+				return is_mutable;
+			}
 
-			template<class S>
-			friend S& operator<<(S&, const Type&);
+			// Structural comparisons, only intended for use by `TypeInterner`
+			// Components are compared by address as they are already interned
+			struct Hash {
+				size_t operator()(const Type& t) const;
+			};
+			struct Equal {
+				bool operator()(const Type& lhs, const Type& rhs) const;
+			};
 	};
 
 	template<class S>
 	S& operator<<(S& stream, const Type& t) {
-		return stream << t.name;
+		if (t.isMutable()) {
+			stream << "mut ";
+		}
+
+		auto print_list = [&](auto front, auto end) {
+			stream << '(';
+			for (auto iter = front; iter != end; ++iter) {
+				if (iter != front) {
+					stream << ", ";
+				}
+				stream << **iter;
+			}
+			stream << ')';
+		};
+
+		auto& parts = t.parts();
+		switch (t.kind()) {
+			case TypeKind::NAMED:
+				return stream << t.name();
+			case TypeKind::GENERIC:
+				stream << t.name() << '[';
+				for (size_t i = 0; i != parts.size(); ++i) {
+					stream << (i ? ", " : "") << *parts[i];
+				}
+				return stream << ']';
+			case TypeKind::ARRAY:
+				return stream << '[' << *parts.front() << ']';
+			case TypeKind::TUPLE:
+				print_list(parts.begin(), parts.end());
+				return stream;
+			case TypeKind::FUNCTION:
+				print_list(parts.begin(), parts.end() - 1);
+				return stream << " -> " << *parts.back();
+			case TypeKind::POINTER:
+				return stream << *parts.front() << '*';
+			case TypeKind::REFERENCE:
+				return stream << *parts.front() << '&';
+			case TypeKind::VIEW:
+				return stream << *parts.front() << "&view";
+		}
+
+		return stream;
 	}
 
 
+	/*
+	 * Arena that hash-conses every type used during analysis
+	 *   Each structurally distinct type is allocated exactly once and never moved
+	 *   So types can be held and compared as plain `const Type*`
+	 */
+	class TypeInterner {
+		std::unordered_set<Type, Type::Hash, Type::Equal> types;
+
+		const Type* intern(TypeKind kind, String name, std::vector<const Type*> parts, bool mut = false);
+
+		public:
+			TypeInterner() = default;
+			TypeInterner(const TypeInterner&) = delete;
+
+			const Type* named(const String& name);
+			const Type* generic(const String& name, std::vector<const Type*> args);
+			const Type* tuple(std::vector<const Type*> elems);
+			const Type* function(std::vector<const Type*> args, const Type* ret);
+			const Type* array(const Type* elem);
+
+			const Type* pointer(const Type* pointee);
+			const Type* reference(const Type* pointee);
+			const Type* view(const Type* pointee);
+			const Type* mut(const Type* type);
+
+			inline size_t size() const {
+				return types.size();
+			}
+	};
+
+
+	/*
+	 * Preresolved handles to the types that the compiler has builtin knowledge of
+	 *   A handle is `nullptr` if the installation doesn't define that type
+	 */
+	struct CoreTypes {
+		const Type* Int = nullptr;
+		const Type* Bool = nullptr;
+		const Type* Float = nullptr;
+		const Type* Char = nullptr;
+		const Type* Byte = nullptr;
+		const Type* String = nullptr;
+	};
+
+
 	/*
 	 * Fill the standard set of spero types for compiler recognition
 	 *
 	 * TODO: This is eventually going to be handled through automatic module loading
 	 */
-	inline const AllTypes& getCoreTypeList() {
-		static AllTypes types {
-			{ "Int", std::make_shared<Type>("Int") },
-			{ "Bool", std::make_shared<Type>("Bool") }
+	inline AllTypes getCoreTypeList(TypeInterner& types) {
+		return {
+			{ string::names::Int, types.named(string::names::Int) },
+			{ string::names::Bool, types.named(string::names::Bool) },
+			{ string::names::Float, types.named(string::names::Float) },
+			{ string::names::Char, types.named(string::names::Char) },
+			{ string::names::Byte, types.named(string::names::Byte) }
 		};
-
-		return types;
 	}
 
-}
\ No newline at end of file
+}
@@ -6,12 +6,15 @@
 #pragma warning(disable:4996)
 //#pragma warning(pop)
 #include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/Intrinsics.h>
+#include <llvm/IR/MDBuilder.h>
 #include <llvm/IR/Module.h>
 #include <llvm/IR/Verifier.h>
 #pragma warning(pop)
 
 #include "parser/AstVisitor.h"
-#include "interface/CompilationState.h"
+#include "interface/CompilationState.h"
+#include "analysis/AnalysisState.h"
 #include "util/parser.h"
 #include "util/ranges.h"
 
@@ -33,20 +36,69 @@ namespace spero::compiler::gen {
 
 		CompilationState& state;
 
+		analysis::AnalysisState& dictionary;
 		analysis::SymArena& arena;
 		static constexpr analysis::SymIndex globals = 0;
 		analysis::SymIndex current = globals;
 
+		// The blocks that `continue` and `break` jump to for every enclosing loop, innermost last
+		std::vector<std::pair<llvm::BasicBlock*, llvm::BasicBlock*>> loops;
+
+		// Generate a loop in canonical form (preheader, header, single latch and exit), `test` is null for infinite loops
+		void generateLoop(ast::Loop&, ast::ValExpr* test);
+
+		// Code after a jump is unreachable, but it still needs a block to be generated into
+		void continueAfterJump();
+
+		// Whether nothing branches into the block (ie. the block that `continueAfterJump` started)
+		static bool isUnreachable(llvm::BasicBlock*);
+
+		// The list of heap arrays that the current function frees when it returns, `nullptr` until it owns one
+		llvm::AllocaInst* owned_arrays = nullptr;
+
+		// Add a heap array that was returned to the current function to the arrays it frees (see `AnalysisState::owned_result`)
+		void ownArray(llvm::Value*);
+
 		protected:
 			llvm::Value* codegen = nullptr;
 			llvm::Value* visitNode(ast::Ast&);
 
+			// The constant for the expression's folded value (see `ConstFoldingPass`), if it has one
+			llvm::Constant* foldedConstant(ast::ValExpr&);
+
+			// Convert a `Bool` value into the `i1` that branches expect
+			llvm::Value* truthValue(llvm::Value*);
+
+			// The llvm representation of an inferred spero type
+			// Types that couldn't be inferred (or can't be lowered yet) are represented as an `i32`
+			// Arrays are represented by a pointer to their first element along with their length, and tuples as llvm structs
+			llvm::Type* lowerType(const analysis::Type*);
+			llvm::Type* lowerTypeOf(ast::ValExpr&);
+
+			// Convert a value to the given numeric representation (ie. when storing an `Int` into a `Float`)
+			// Tuples are converted element by element and unit becomes the zero value of the type
+			// Other values that can't be converted are returned unchanged
+			llvm::Value* coerce(llvm::Value*, llvm::Type*);
+
+			// Allocate stack storage in the current function's entry block, so it's only allocated once per call
+			llvm::AllocaInst* createEntryAlloca(llvm::Type*, const llvm::Twine& name = "");
+
+			// Branch weights for the statement's test if it's annotated with `@likely` or `@unlikely`, `nullptr` otherwise
+			llvm::MDNode* expectedWeights(ast::Statement&);
+
+			// `llvm.loop` metadata for the loop's `@vectorize` and `@unroll` annotations, `nullptr` if it has none
+			llvm::MDNode* loopMetadata(ast::Statement&);
+
 		public:
-			LlvmIrGenerator(analysis::SymArena& arena, CompilationState& state);
-			LlvmIrGenerator(std::unique_ptr<llvm::Module> mod, analysis::SymArena& arena, CompilationState& state);
+			LlvmIrGenerator(analysis::AnalysisState& dict, CompilationState& state);
+			LlvmIrGenerator(std::unique_ptr<llvm::Module> mod, analysis::AnalysisState& dict, CompilationState& state);
 
 			std::unique_ptr<llvm::Module> finalize();
 
+			// Create the llvm prototype for the function, if it hasn't been declared yet
+			// Declaring every function upfront lets calls refer to functions that are defined later
+			llvm::Function* declareFunction(ast::Function&);
+
 			// Literals
 			virtual void visitBool(ast::Bool&) final;
 			virtual void visitByte(ast::Byte&) final;
@@ -56,19 +108,25 @@ namespace spero::compiler::gen {
 
 			// Atoms
 			virtual void visitTuple(ast::Tuple&) final;
+			virtual void visitArray(ast::Array&) final;
 			virtual void visitBlock(ast::Block&) final;
 			virtual void visitFunction(ast::Function&) final;
 
 			// Names
 			virtual void visitVariable(ast::Variable&) final;
 			virtual void visitAssignName(ast::AssignName&) final;
+			virtual void visitAssignTuple(ast::AssignTuple&) final;
 
 			// Decorations
 			virtual void visitArgument(ast::Argument&) final;
 
 			// Control
+			virtual void visitLoop(ast::Loop&) final;
+			virtual void visitWhile(ast::While&) final;
+			virtual void visitFor(ast::For&) final;
 			virtual void visitIfBranch(ast::IfBranch&) final;
 			virtual void visitIfElse(ast::IfElse&) final;
+			virtual void visitJump(ast::Jump&) final;
 			
 			// Statements
 			virtual void visitVarAssign(ast::VarAssign& v) final;
@@ -77,6 +135,7 @@ namespace spero::compiler::gen {
 			virtual void visitInAssign(ast::InAssign&) final;
 			virtual void visitBinOpCall(ast::BinOpCall&) final;
 			virtual void visitUnOpCall(ast::UnOpCall&) final;
+			virtual void visitIndex(ast::Index&) final;
 			virtual void visitFnCall(ast::FnCall&) final;
 	};
 
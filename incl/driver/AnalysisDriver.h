@@ -1,13 +1,34 @@
 #pragma once
 
+#include <unordered_set>
+
 #include "interface/CompilationState.h"
-#include "analysis/AnalysisState.h"
+#include "analysis/AnalysisState.h"
+#include "analysis/QueryEngine.h"
 
 namespace llvm {
+	class GlobalValue;
 	class LLVMContext;
 	class Module;
 }
 
+namespace spero::compiler::ast {
+	struct VarAssign;
+}
+
+namespace spero::compiler::gen {
+	class LlvmIrGenerator;
+}
+
+namespace spero::analysis {
+	class VarRefPass;
+}
+
+namespace spero::parser {
+	class ParseStack;
+	struct TextEdit;
+}
+
 namespace spero::compiler {
 
 	using SperoModule = std::unique_ptr<llvm::Module>;
@@ -23,24 +44,80 @@ namespace spero::compiler {
 			Optimizer* opt = nullptr;
 
 			parser::Stack ast;
-			analysis::AnalysisState decls;
+			analysis::AnalysisState decls;
+			analysis::QueryEngine queries;
 			SperoModule translation_unit = nullptr;
 
 		protected:
 			// Frontend: source -> AST
+			bool parseStack(parser::ParsingMode parser_mode, const std::string& input, parser::ParseStack& stack);
 			void parseInput(parser::ParsingMode parser_mode, const std::string& input);
 
+			// Split the input at top-level declarations and parse the chunks on separate threads
+			void parseChunks(parser::ParsingMode parser_mode, const std::string& input, size_t jobs);
+
+			// Cache: binary ast file <-> AST
+			//   `loadAst` returns false (without logging) if the file isn't a binary ast
+			bool loadAst(const std::string& file);
+			void saveAst(const std::string& file);
+
+			// Incremental: re-parse only the top-level statements of `old_source` that `edit` touches (see `recompile`)
+			//   Every other statement of the current ast is reused, the statements it replaced are moved into `replaced`
+			//   Returns the edited source
+			std::string reparseInput(const std::string& old_source, const parser::TextEdit& edit, parser::Stack& replaced);
+
+			// Drop every fact about the statement and release its scopes, before it's replaced or analyzed again
+			//   The module values that it defined are collected into `stale`, as they can only be found through those facts
+			void forgetStatement(ast::Ast& stmt, std::unordered_set<llvm::GlobalValue*>& stale);
+
+			// Erase the stale values from the module, along with the private constants that only they used
+			//   Returns false (leaving the values in place) if anything else still refers to them
+			bool eraseDefinitions(const std::unordered_set<llvm::GlobalValue*>& stale);
+
+			// Streaming: source -> LLVM IR, one top-level statement at a time
+			//   Parsing runs on a separate thread and each statement is analyzed and translated
+			//   (and then freed) as soon as every global name it depends on has been emitted
+			//   Statements that wait on each other (ie. mutually recursive functions) are emitted together once the input ends
+			//   Pure functions are only freed once the input ends, as later statements may evaluate calls to them at compile time
+			void streamInput(parser::ParsingMode parser_mode, const std::string& input);
+
+			// Queries: bring the program inputs of `queries` in line with the current ast
+			//   Statements that weren't replaced since the last update keep their cached facts
+			//   Returns the statements that were added, and every global name bound by an added or removed statement
+			struct ProgramChanges {
+				std::vector<ast::NodeId> added;
+				std::unordered_set<String> names;
+			};
+			ProgramChanges updateProgramQueries();
+
 			// Analysis: AST -> MIR (LLVM IR)
 			void analyzeAst();
 
+			// Run every pass that follows declaration over the statements, in order
+			//   Batch and streaming compiles both go through this, so they see the same facts
+			//   `refs` is kept by the caller, as the statements may be analyzed in several batches
+			void analyzeStatements(analysis::VarRefPass& refs, const std::vector<ast::Ast*>& stmts);
+
 			// Backend: MIR (LLVM IR) -> LLVM IR
 			virtual void translateAstToLlvm();
+
+			// Lower the statements with `generator`, declaring every function upfront and defining callees first
+			//   With `prune`, only the functions reachable from `main` and the exported definitions (of the whole ast) are lowered
+			void translateStatements(gen::LlvmIrGenerator& generator, const std::vector<ast::Ast*>& stmts, bool prune);
+			virtual bool isExported(const ast::VarAssign& def);
 			void optimizeLlvm();
 			//void updateOptimizationLevel();
 
 		public:
 			AnalysisDriver(CompilationState& state);
 
+			// Incremental: apply `edit` to `old_source` (the source of the last translated program) and translate the result
+			//   Only the edited statements, and those that (transitively) use a global name they bind, are analyzed again
+			//   Every other statement keeps its nodes, facts and module values, unless the last compile failed or an affected name is declared twice
+			//   The affected statements are translated again into the existing module, in place of their old values
+			//   Returns the edited source
+			std::string recompile(const std::string& old_source, const parser::TextEdit& edit);
+
 			inline CompilationState& getState() {
 				return state;
 			}
@@ -10,6 +10,9 @@ namespace spero::compiler {
 			void writeLlvmToFile();
 			void triggerClangCompile();
 
+			// Incremental: recompile the analyzed `input` as if it had been edited into the `edited` file
+			void applyEdit(parser::ParsingMode parser_mode, const std::string& input, const std::string& edited);
+
 		public:
 			CompilationDriver(CompilationState& state);
 
@@ -15,6 +15,9 @@ namespace spero::compiler {
 			// Prepare the repl for the next iteration
 			bool reset();
 
+			// Later lines may call any function defined in the repl, so none of them can be dropped
+			virtual bool isExported(const ast::VarAssign&) final;
+
 		public:
 			ReplDriver(CompilationState& state);
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <deque>
 
@@ -13,6 +14,7 @@
 #pragma warning(pop)
 
 #include "parser/base.h"
+#include "spero_string.h"
 #include "util/time.h"
 
 #define abstract =0;
@@ -45,9 +47,15 @@ namespace spero::compiler {
 	 * specified compilation state from all parts of the compiler
 	 */
 	class CompilationState {
+		// NOTE: Declared first so that every String created during compilation is reclaimed last
+		// They're only made current by scopes on the stack of the threads that use them (see `main`)
+		string::Interner interner;
+		ast::NodeIds node_ids;
+
 		std::deque<std::string> input_files;
 		std::deque<std::pair<std::string, util::TimeData>> timing;
-		int nerrs = 0;
+		// NOTE: Atomic as errors may be reported from the parser thread when streaming
+		std::atomic<int> nerrs{ 0 };
 
 		std::shared_ptr<spdlog::logger> logger;
 		CompilationPermissions permissions;
@@ -86,12 +94,18 @@ namespace spero::compiler {
 			virtual bool deleteTemporaryFiles() abstract;
 			virtual bool showLogs() abstract;
 			virtual bool produceExe() abstract;
+			virtual bool streamStatements() abstract;
+			virtual size_t parserThreads() abstract;
+			virtual std::string astOutput() abstract;
+			virtual std::string editedInput() abstract;
 			virtual std::string targetTriple() abstract;
 			virtual std::string targetDataLayout() abstract;
 			OptimizationLevel optimizationLevel();
 			void flipOptimization();
 
 			llvm::LLVMContext& getContext();
+			string::Interner& strings();
+			ast::NodeIds& nodeIds();
 			int failed() const;
 			void reset();
 
@@ -136,6 +150,22 @@ namespace spero::compiler {
 			return !opts["stop"].as<bool>();
 		}
 
+		bool streamStatements() {
+			return opts["stream"].as<bool>();
+		}
+
+		size_t parserThreads() {
+			return opts["jobs"].as<size_t>();
+		}
+
+		std::string astOutput() {
+			return opts.count("emit-ast") ? opts["emit-ast"].as<std::string>() : "";
+		}
+
+		std::string editedInput() {
+			return opts.count("edit") ? opts["edit"].as<std::string>() : "";
+		}
+
 		std::string targetTriple() {
 			return "x86_64-pc-windows-msvc19.16.27025";
 		}
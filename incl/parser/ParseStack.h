@@ -0,0 +1,181 @@
+#pragma once
+
+#include <functional>
+#include <variant>
+#include <vector>
+
+#include "parser/ast.h"
+#include "interface/CompilationState.h"
+#include "util/parser.h"
+
+namespace spero::parser {
+
+	/*
+	 * Typed value stack that the parser actions reduce the source onto
+	 *   Keywords, delimiters and sentinels are stored inline as small tagged values instead of
+	 *   heap-allocated ast nodes. Only real ast nodes are stored by handle (`ptr<ast::Ast>`)
+	 *
+	 * Opening delimiters (`pushSymbol`) and `openFrame` start a new reduction frame, which records
+	 *   where a sequenced construct (ie. tuple, scope, index) begins. Reductions can then collect
+	 *   their elements with `popFrame` instead of scanning the stack for the delimiter
+	 *
+	 * Exports:
+	 *   push/pushToken/pushSymbol/pushSentinel - add an entry to the top of the stack
+	 *   at/atToken/view/loc - query the top entries of the stack
+	 *   pop/popToken/popSymbol/pop_back - remove the top entry of the stack
+	 *   popSeq - pop the run of `Node`s at the top of the stack (for un-delimited sequences)
+	 *   popFrame - pop every node pushed since the current frame was opened
+	 *   closeFrame - remove the current frame's opening entry, leaving the frame's contents in place
+	 *   moveNodesInto - transfer the reduced entries into the final ast stack
+	 *   streamTo/flush - hand completed top-level entries to a consumer as soon as they are reduced
+	 */
+	class ParseStack {
+		public:
+			struct Token {
+				compiler::ast::Token::token_type value;
+				compiler::Location loc;
+
+				template<class T, class=std::enable_if_t<compiler::can_hold_v<T, compiler::ast::Token::token_type>>>
+				bool holds() const { return std::holds_alternative<T>(value); }
+
+				template<class T, class=std::enable_if_t<compiler::can_hold_v<T, compiler::ast::Token::token_type>>>
+				T get() const { return std::get<T>(value); }
+			};
+			struct Symbol {
+				char ch;
+				compiler::Location loc;
+			};
+			struct Sentinel {
+				compiler::Location loc;
+			};
+
+			using Entry = std::variant<compiler::ptr<compiler::ast::Ast>, Token, Symbol, Sentinel>;
+
+		private:
+			std::vector<Entry> entries;
+
+			// Indices of the entries that opened each active reduction frame (innermost last)
+			std::vector<size_t> frames;
+
+			std::function<void(compiler::ptr<compiler::ast::Ast>)> sink;
+
+			inline compiler::ast::Ast* node(size_t depth = 0) const {
+				if (entries.size() <= depth) {
+					return nullptr;
+				}
+
+				auto* node = std::get_if<compiler::ptr<compiler::ast::Ast>>(&entries[entries.size() - depth - 1]);
+				return node ? node->get() : nullptr;
+			}
+
+			inline size_t frameStart() const {
+				return frames.empty() ? 0 : frames.back() + 1;
+			}
+
+		public:
+			// Mutation interfaces
+			template<class Node>
+			void push(compiler::ptr<Node> node) {
+				entries.emplace_back(compiler::ptr<compiler::ast::Ast>{ std::move(node) });
+			}
+			template<class T>
+			void pushToken(T val, compiler::Location loc) {
+				entries.emplace_back(Token{ val, std::move(loc) });
+			}
+			void pushSymbol(char ch, compiler::Location loc);
+			void pushSentinel(compiler::Location loc);
+
+			// Open a frame underneath the current top entry (which becomes the frame's first element)
+			void openFrame(compiler::Location loc);
+
+			// Query interfaces
+			inline size_t size() const {
+				return entries.size();
+			}
+			inline bool empty() const {
+				return entries.empty();
+			}
+
+			template<class Node>
+			bool at() const {
+				return dynamic_cast<Node*>(node()) != nullptr;
+			}
+			template<class T>
+			bool atToken() const {
+				auto* tkn = entries.empty() ? nullptr : std::get_if<Token>(&entries.back());
+				return tkn && tkn->holds<T>();
+			}
+			template<class T>
+			bool atToken(T val) const {
+				return atToken<T>() && std::get<Token>(entries.back()).get<T>() == val;
+			}
+			template<class Node>
+			Node* view() const {
+				return dynamic_cast<Node*>(node());
+			}
+			const compiler::Location& loc(size_t depth = 0) const;
+
+			// Pop interfaces
+			template<class Node>
+			compiler::ptr<Node> pop() {
+				static_assert(!std::is_same_v<Node, compiler::ast::Token> && !std::is_same_v<Node, compiler::ast::Symbol>,
+					"Tokens and symbols are stored inline, use `popToken` or `popSymbol`");
+
+				if (!at<Node>()) {
+					return nullptr;
+				}
+
+				auto ret = util::dynCast<Node>(std::move(std::get<compiler::ptr<compiler::ast::Ast>>(entries.back())));
+				pop_back();
+				return std::move(ret);
+			}
+			opt_t<Token> popToken();
+			opt_t<Symbol> popSymbol();
+			void pop_back();
+
+			template<class Node>
+			std::deque<compiler::ptr<Node>> popSeq() {
+				std::deque<compiler::ptr<Node>> ret;
+
+				while (at<Node>()) {
+					ret.push_front(pop<Node>());
+				}
+
+				return std::move(ret);
+			}
+
+			template<class Node>
+			std::deque<compiler::ptr<Node>> popFrame() {
+				// Un-delimited sequences don't open a frame, so there's nothing to bound the collection
+				if (frames.empty()) {
+					return popSeq<Node>();
+				}
+
+				std::deque<compiler::ptr<Node>> ret;
+				auto start = frameStart();
+
+				// Any non-node entries left inside the frame are only the remains of error recovery
+				for (auto i = start; i != entries.size(); ++i) {
+					if (auto* node = std::get_if<compiler::ptr<compiler::ast::Ast>>(&entries[i])) {
+						if (auto elem = util::dynCast<Node>(std::move(*node))) {
+							ret.push_back(std::move(elem));
+						}
+					}
+				}
+
+				entries.erase(entries.begin() + start, entries.end());
+				return std::move(ret);
+			}
+
+			opt_t<Symbol> closeFrame();
+
+			// Transfer every entry into the final ast (inline tokens and symbols are materialized as nodes)
+			void moveNodesInto(Stack& ast);
+
+			// Streaming interfaces
+			//   `flush` is called whenever a top-level statement is reduced and is a no-op unless a sink is set
+			void streamTo(std::function<void(compiler::ptr<compiler::ast::Ast>)> consumer);
+			void flush();
+	};
+
+}
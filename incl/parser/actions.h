@@ -4,6 +4,7 @@
 
 #include "grammar.h"
 #include "interface/CompilationState.h"
+#include "parser/ParseStack.h"
 #include "util/parser.h"
 #include "util/strings.h"
 
@@ -13,20 +14,21 @@
 #define RULE(gram) \
 	template<> struct action<grammar::gram> { \
 		template<class Input> \
-		static void apply(const Input& in, Stack& s, CompilationState& state)
+		static void apply(const Input& in, ParseStack& s, CompilationState& state)
 #define END }
 #define LOCATION Location{ in.iterator(), in.input().source() }
+#define IN_VIEW std::string_view{ in.begin(), in.size() }
 #define MAKE(Node, ...) std::make_unique<ast::Node>(__VA_ARGS__, LOCATION)
-#define PUSH(Node, ...) s.emplace_back(MAKE(Node, __VA_ARGS__))
+#define PUSH(Node, ...) s.push(MAKE(Node, __VA_ARGS__))
 #define MAKE_NODE(Node) std::make_unique<ast::Node>(LOCATION)
-#define PUSH_NODE(Node) s.emplace_back(MAKE_NODE(Node))
-#define POP(Node) util::pop<ast::Node>(s)
+#define PUSH_NODE(Node) s.push(MAKE_NODE(Node))
+#define POP(Node) s.pop<ast::Node>()
 #define INHERIT(gram, base) template<> struct action<grammar::gram> : action<grammar::base> {}
 
 
-// Common case sentinel and token nodes
-#define SENTINEL(gram)		RULE(gram) { s.emplace_back(ast::Sentinel{}); } END
-#define TOKEN(gram, val)	RULE(gram) { PUSH(Token, val); } END
+// Common case sentinel and token entries (stored inline on the stack)
+#define SENTINEL(gram)		RULE(gram) { s.pushSentinel(LOCATION); } END
+#define TOKEN(gram, val)	RULE(gram) { s.pushToken(val, LOCATION); } END
 
 
 namespace spero::parser::actions {
@@ -39,11 +41,11 @@ namespace spero::parser::actions {
 	//
 	// Sentinel Nodes
 	//
-	RULE(obrace) { PUSH(Symbol, '{'); } END;
-	RULE(obrack) { PUSH(Symbol, '['); } END;
-	RULE(oparen) { PUSH(Symbol, '('); } END;
-	RULE(ochar) { PUSH(Symbol, '\''); } END;
-	RULE(oquote) { PUSH(Symbol, '"'); } END;
+	RULE(obrace) { s.pushSymbol('{', LOCATION); } END;
+	RULE(obrack) { s.pushSymbol('[', LOCATION); } END;
+	RULE(oparen) { s.pushSymbol('(', LOCATION); } END;
+	RULE(ochar) { s.pushSymbol('\'', LOCATION); } END;
+	RULE(oquote) { s.pushSymbol('"', LOCATION); } END;
 
 
 	//
@@ -66,36 +68,52 @@ namespace spero::parser::actions {
 	// Literals (done)
 	//
 	RULE(bin_body) {
-		if (in.string().size() == 0) {
+		if (in.size() == 0) {
 			state.log(compiler::ID::err, "Missing binary body: `0b` must be followed by a sequence of binary digits <at {}>", LOCATION);
 			PUSH_NODE(ValError);
+		} else if (auto val = util::toNumber<unsigned long>(IN_VIEW, 2); val) {
+			PUSH(Byte, *val);
 		} else {
-			PUSH(Byte, in.string(), 2);
+			state.log(compiler::ID::err, "Binary literal `0b{}` is too large to be represented <at {}>", IN_VIEW, LOCATION);
+			PUSH_NODE(ValError);
 		}
 	} END;
 	RULE(hex_body) {
-		if (in.string().size() == 0) {
+		if (in.size() == 0) {
 			state.log(compiler::ID::err, "Missing hex body: `0x` must be followed by a sequence of hexadecimal digits <at {}>", LOCATION);
 			PUSH_NODE(ValError);
+		} else if (auto val = util::toNumber<unsigned long>(IN_VIEW, 16); val) {
+			PUSH(Byte, *val);
 		} else {
-			PUSH(Byte, in.string(), 16);
+			state.log(compiler::ID::err, "Hex literal `0x{}` is too large to be represented <at {}>", IN_VIEW, LOCATION);
+			PUSH_NODE(ValError);
 		}
 	} END;
 	RULE(decimal) {
-		if (auto str = in.string(); str.find('.') != std::string::npos) {
-			PUSH(Float, str);
-		} else {
-			PUSH(Int, str);
+		// NOTE: The match includes any trailing whitespace/comments, so only the digits decide the literal kind
+		auto str = IN_VIEW;
+		auto num_end = str.find_first_not_of("0123456789");
+
+		if (num_end != std::string_view::npos && str[num_end] == '.') {
+			if (auto val = util::toNumber<double>(str); val) {
+				PUSH(Float, *val);
+				return;
+			}
+		} else if (auto val = util::toNumber<long>(str); val) {
+			PUSH(Int, *val);
+			return;
 		}
+
+		state.log(compiler::ID::err, "Number literal `{}` is too large to be represented <at {}>", str.substr(0, str.find_first_of(" \t\r\n#")), LOCATION);
+		PUSH_NODE(ValError);
 	} END;
 	RULE(char_body) {
-		PUSH(Char, in.string()[0]);
+		PUSH(Char, *in.begin());
 	} END;
 	RULE(_char) {
 		// stack: {} char error?
 		auto err = POP(CloseSymbolError);
-		std::iter_swap(std::rbegin(s), std::rbegin(s) + 1);
-		auto sym = POP(Symbol);
+		auto sym = s.closeFrame();
 
 		if (err) {
 			state.log(compiler::ID::err, "No closing quote found for opening ' <char at {}>", sym->loc);
@@ -103,13 +121,12 @@ namespace spero::parser::actions {
 		// stack: char
 	} END;
 	RULE(str_body) {
-		PUSH(String, util::escape(in.string()));
+		PUSH(String, util::escape(IN_VIEW));
 	} END;
 	RULE(string) {
 		// stack: {} char error?
 		auto err = POP(CloseSymbolError);
-		std::iter_swap(std::rbegin(s), std::rbegin(s) + 1);
-		auto sym = POP(Symbol);
+		auto sym = s.closeFrame();
 
 		if (err) {
 			state.log(compiler::ID::err, "No closing quote found for opening \" <string at {}>", sym->loc);
@@ -133,10 +150,10 @@ namespace spero::parser::actions {
 	RULE(scope) {
 		// stack: symbol stmt* error?
 		auto err = POP(CloseSymbolError);
-		auto vals = util::popSeq<ast::Statement>(s);
+		auto vals = s.popFrame<ast::Statement>();
 
 		// Error Handling
-		auto sym = POP(Symbol);
+		auto sym = s.popSymbol();
 		if (err) {
 			state.log(compiler::ID::err, "No closing brace found for opening '{}' <scope at {}>", '{', sym->loc);
 		}
@@ -151,10 +168,10 @@ namespace spero::parser::actions {
 	RULE(tuple) {
 		// stack: symbol valexpr* error?
 		auto err = POP(CloseSymbolError);
-		auto vals = util::popSeq<ast::ValExpr>(s);
+		auto vals = s.popFrame<ast::ValExpr>();
 
 		// Error Handling
-		auto sym = POP(Symbol);
+		auto sym = s.popSymbol();
 		if (err) {
 			state.log(compiler::ID::err, "No closing parenthesis found for opening '(' <tuple at {}>", sym->loc);
 		}
@@ -169,10 +186,10 @@ namespace spero::parser::actions {
 	RULE(_array) {
 		// stack: {} valexpr*
 		auto err = POP(CloseSymbolError);
-		auto vals = util::popSeq<ast::ValExpr>(s);
+		auto vals = s.popFrame<ast::ValExpr>();
 
 		// Error Handling
-		auto sym = POP(Symbol);
+		auto sym = s.popSymbol();
 		if (err) {
 			state.log(compiler::ID::err, "No closing bracket found for opening '[' <array at {}>", sym->loc);
 		}
@@ -182,13 +199,13 @@ namespace spero::parser::actions {
 	} END;
 	RULE(missing_lexpr) {
 		// stack: tuple
-		state.log(compiler::ID::err, "Missing function body indicated by '->' <lambda at {}>", s.back()->loc);
+		state.log(compiler::ID::err, "Missing function body indicated by '->' <lambda at {}>", s.loc());
 		PUSH_NODE(ValError);
 		// stack: tuple error
 	} END;
 	RULE(lambda) {
 		// stack: tuple expr
-		if (!util::atNode<ast::Block>(s)) {
+		if (!s.at<ast::Block>()) {
 			auto val = POP(Statement);
 			std::deque<ptr<ast::Statement>> vals;
 			vals.emplace_front(std::move(val));
@@ -244,31 +261,31 @@ namespace spero::parser::actions {
 	// Identifiers
 	//
 	RULE(typ) {
-		PUSH(BasicBinding, in.string(), ast::BindingType::TYPE);
+		PUSH(BasicBinding, spero::intern(IN_VIEW), ast::BindingType::TYPE);
 	} END;
 	RULE(var) {
-		PUSH(BasicBinding, in.string(), ast::BindingType::VARIABLE);
+		PUSH(BasicBinding, spero::intern(IN_VIEW), ast::BindingType::VARIABLE);
 
 		// TODO: Figure out how to make the short version work
-		if (tao::pegtl::parse<grammar::keywords>(tao::pegtl::string_input<>{ in.string(), "" })) {
+		if (tao::pegtl::parse<grammar::keywords>(tao::pegtl::memory_input<>{ in.begin(), in.size(), "" })) {
 		//if (tao::pegtl::parse<grammar::keywords>(in)) {
-			state.log(compiler::ID::err, "Attempt to use language keyword '{}' as variable <var at {}>", in.string(), LOCATION);
+			state.log(compiler::ID::err, "Attempt to use language keyword '{}' as variable <var at {}>", IN_VIEW, LOCATION);
 		}
 	} END;
 	RULE(op) {
-		PUSH(BasicBinding, in.string(), ast::BindingType::OPERATOR);
+		PUSH(BasicBinding, spero::intern(IN_VIEW), ast::BindingType::OPERATOR);
 	} END;
 	INHERIT(unop, op);
 	INHERIT(binop, op);
 	RULE(ptyp) {
-		PUSH(PathPart, in.string(), ast::BindingType::TYPE);
+		PUSH(PathPart, spero::intern(IN_VIEW), ast::BindingType::TYPE);
 	} END;
 	RULE(pvar) {
-		PUSH(PathPart, in.string(), ast::BindingType::VARIABLE);
+		PUSH(PathPart, spero::intern(IN_VIEW), ast::BindingType::VARIABLE);
 
-		if (tao::pegtl::parse<grammar::keywords>(tao::pegtl::string_input<>{ in.string(), "" })) {
+		if (tao::pegtl::parse<grammar::keywords>(tao::pegtl::memory_input<>{ in.begin(), in.size(), "" })) {
 		//if (tao::pegtl::parse<grammar::keywords>(in))) {
-			state.log(compiler::ID::err, "Attempt to use language keyword '{}' as variable <var at {}>", in.string(), LOCATION);
+			state.log(compiler::ID::err, "Attempt to use language keyword '{}' as variable <var at {}>", IN_VIEW, LOCATION);
 		}
 	} END;
 	RULE(path_part) {
@@ -277,16 +294,16 @@ namespace spero::parser::actions {
 		auto part = POP(PathPart);
 		part->gens = std::move(gens);
 
-		if (!util::atNode<ast::Path>(s)) {
+		if (!s.at<ast::Path>()) {
 			PUSH(Path, std::move(part));
 		} else {
-			util::viewAs<ast::Path>(s.back())->elems.push_back(std::move(part));
+			s.view<ast::Path>()->elems.push_back(std::move(part));
 		}
 		// stack: Path
 	} END;
 	RULE(typname) {
 		// stack: Path
-		if (auto* node = util::viewAs<ast::Path>(s.back()); node) {
+		if (auto* node = s.view<ast::Path>(); node) {
 			if (node->elems.back()->type != +ast::BindingType::TYPE) {
 				state.log(compiler::ID::err, "Expected type name, found something else <qualtyp at {}>", node->loc);
 			}
@@ -299,10 +316,10 @@ namespace spero::parser::actions {
 	RULE(pat_tuple) {
 		// stack: {} pattern* error?
 		auto err = POP(CloseSymbolError);
-		auto pats = util::popSeq<ast::Pattern>(s);
+		auto pats = s.popFrame<ast::Pattern>();
 
 		// Error Handling
-		auto sym = POP(Symbol);
+		auto sym = s.popSymbol();
 		if (err) {
 			state.log(compiler::ID::err, "No closing parenthesis found for opening '(' <pat_tuple at {}>", sym->loc);
 		}
@@ -318,42 +335,38 @@ namespace spero::parser::actions {
 	} END;
 	RULE(pat_missing) {
 		// stack: cap?
-		if (util::atNode<ast::Token>(s) && util::viewAs<ast::Token>(s.back())->holds<ast::CaptureType>()) {
+		if (s.atToken<ast::CaptureType>()) {
 			state.log(compiler::ID::err, "Missing pattern to match specified capture declaration <pattern at {}>", LOCATION);
 		} else {
-			state.log(compiler::ID::err, "Unexpected Input: Could not match Spero expression \"{}\" <pattern at {}>", in.string(), LOCATION);
+			state.log(compiler::ID::err, "Unexpected Input: Could not match Spero expression \"{}\" <pattern at {}>", IN_VIEW, LOCATION);
 		}
 		PUSH_NODE(Pattern);
 		// stack: Pattern
 	} END;
 	RULE(capture_desc) {
 		// stack: kmut?
-		if (in.string().size() == 0) {
-			PUSH(Token, ast::CaptureType::NORM);
+		if (in.size() == 0) {
+			s.pushToken(ast::CaptureType::NORM, LOCATION);
 			return;
 		}
 
-		bool is_ref = (in.string()[0] == '&');
-		bool is_mut = false;
-
-		if (auto* node = util::viewAs<ast::Token>(s.back()); node) {
-			is_mut = node->holds<ast::KeywordType>() && node->get<ast::KeywordType>() == +ast::KeywordType::MUT;
-		}
+		bool is_ref = (*in.begin() == '&');
+		bool is_mut = s.atToken(+ast::KeywordType::MUT);
 
 		if (is_mut) {
 			s.pop_back();
-			PUSH(Token, is_ref ? ast::CaptureType::MUTREF : ast::CaptureType::MUT);
+			s.pushToken(is_ref ? ast::CaptureType::MUTREF : ast::CaptureType::MUT, LOCATION);
 
 		} else if (is_ref) {
-			PUSH(Token, ast::CaptureType::REF);
+			s.pushToken(ast::CaptureType::REF, LOCATION);
 		}
 		// stack: cap
 	} END;
 	RULE(capture) {
 		// stack: cap pattern
 		auto pat = POP(Pattern);
-		pat->cap = POP(Token)->get<ast::CaptureType>();
-		s.emplace_back(std::move(pat));
+		pat->cap = s.popToken()->get<ast::CaptureType>();
+		s.push(std::move(pat));
 		// stack: pattern
 	} END;
 	RULE(pat_any) {
@@ -364,18 +377,18 @@ namespace spero::parser::actions {
 	} END;
 	RULE(resolve_constants) {
 		// stack: path
-		if (util::atNode<ast::Path>(s)) {
-			if (util::viewAs<ast::Path>(s.back())->elems.back()->type == +ast::BindingType::TYPE) {
+		if (s.at<ast::Path>()) {
+			if (s.view<ast::Path>()->elems.back()->type == +ast::BindingType::TYPE) {
 				return action<grammar::pat_adt>::apply(in, s, state);
 			}
 
 			auto name = POP(Path);
 			if (name->elems.size() > 1) {
-				s.emplace_back(std::make_unique<ast::Variable>(std::move(name), name->loc));
+				s.push(std::make_unique<ast::Variable>(std::move(name), name->loc));
 				action<grammar::pat_lit>::apply(in, s, state);
 
 			} else {
-				s.emplace_back(std::make_unique<ast::VarPattern>(std::move(name), name->loc));
+				s.push(std::make_unique<ast::VarPattern>(std::move(name), name->loc));
 			}
 		}
 		// stack: patlit | patname
@@ -391,10 +404,10 @@ namespace spero::parser::actions {
 	RULE(assign_tuple) {
 		// stack: {} asgn_pat* error?
 		auto err = POP(CloseSymbolError);
-		auto pats = util::popSeq<ast::AssignPattern>(s);
+		auto pats = s.popFrame<ast::AssignPattern>();
 
 		// Error Handling
-		auto sym = POP(Symbol);
+		auto sym = s.popSymbol();
 		if (err) {
 			state.log(compiler::ID::err, "No closing parenthesis found for opening '(' <assign_tuple at {}>", sym->loc);
 		}
@@ -422,9 +435,9 @@ namespace spero::parser::actions {
 	} END;
 	RULE(ref_type) {
 		// stack: type ptrStyle?
-		if (auto tkn = POP(Token); tkn) {
+		if (auto tkn = s.popToken(); tkn) {
 			if (tkn->holds<ast::PtrStyling>()) {
-				util::viewAs<ast::SourceType>(s.back())->_ptr = tkn->get<ast::PtrStyling>();
+				s.view<ast::SourceType>()->_ptr = tkn->get<ast::PtrStyling>();
 			}
 		}
 		// stack: type
@@ -435,10 +448,10 @@ namespace spero::parser::actions {
 	RULE(tuple_type) {
 		// stack: {} type* error?
 		auto err = POP(CloseSymbolError);
-		auto types = util::popSeq<ast::Type>(s);
+		auto types = s.popFrame<ast::Type>();
 
 		// Error Handling
-		auto sym = POP(Symbol);
+		auto sym = s.popSymbol();
 		if (err) {
 			state.log(compiler::ID::err, "No closing parenthesis found for opening '(' <tuple_type at {}>", sym->loc);
 		}
@@ -457,7 +470,7 @@ namespace spero::parser::actions {
 			state.log(compiler::ID::err, "Missing required return type information <fn_type at {}>", LOCATION);
 		}
 
-		if (!util::atNode<ast::TupleType>(s)) {
+		if (!s.at<ast::TupleType>()) {
 			PUSH(TupleType, std::deque<ptr<ast::Type>>{});
 			state.log(compiler::ID::err, "Missing required argument type information <fn_type at {}>", LOCATION);
 		}
@@ -469,24 +482,23 @@ namespace spero::parser::actions {
 		// stack: kmut? type
 		auto typ = POP(Type);
 
-		if (auto tkn = POP(Token); tkn) {
+		if (auto tkn = s.popToken(); tkn) {
 			if (tkn->holds<ast::KeywordType>()) {
 				typ->is_mut = (tkn->get<ast::KeywordType>() == +ast::KeywordType::MUT);
 			} else {
-				s.push_back(std::move(tkn));
+				s.pushToken(tkn->value, std::move(tkn->loc));
 			}
 		}
 
-		s.push_back(std::move(typ));
+		s.push(std::move(typ));
 		// stack: type
 	} END;
 	RULE(braced_type) {
 		// stack: {} type error?
 		auto err = POP(CloseSymbolError);
-		std::iter_swap(std::rbegin(s), std::rbegin(s) + 1);
 
 		// Error handling
-		auto sym = POP(Symbol);
+		auto sym = s.closeFrame();
 		if (err) {
 			state.log(compiler::ID::err, "No closing parenthesis found for opening '{}' <braced_type at {}>", '{', sym->loc);
 		}
@@ -501,11 +513,11 @@ namespace spero::parser::actions {
 			state.log(compiler::ID::err, "Missing required type information <and_type at {}>", LOCATION);
 		}
 
-		if (!util::atNode<ast::AndType>(s)) {
+		if (!s.at<ast::AndType>()) {
 			PUSH(AndType, POP(Type));
 		}
 
-		util::viewAs<ast::AndType>(s.back())->elems.push_back(std::move(typ));
+		s.view<ast::AndType>()->elems.push_back(std::move(typ));
 		// stack: and_type
 	} END;
 	RULE(or_cont) {
@@ -517,11 +529,11 @@ namespace spero::parser::actions {
 			state.log(compiler::ID::err, "Missing required type information <and_type at {}>", LOCATION);
 		}
 
-		if (!util::atNode<ast::OrType>(s)) {
+		if (!s.at<ast::OrType>()) {
 			PUSH(OrType, POP(Type));
 		}
 
-		util::viewAs<ast::OrType>(s.back())->elems.push_back(std::move(typ));
+		s.view<ast::OrType>()->elems.push_back(std::move(typ));
 		// stack: or_type
 	} END;
 
@@ -551,20 +563,20 @@ namespace spero::parser::actions {
 		// stack: type?
 	} END;
 	RULE(variance) {
-		if (in.string().size() == 0) {
-			PUSH(Token, ast::VarianceType::INVARIANT);
-		} else if (in.string()[0] == '+') {
-			PUSH(Token, ast::VarianceType::COVARIANT);
+		if (in.size() == 0) {
+			s.pushToken(ast::VarianceType::INVARIANT, LOCATION);
+		} else if (*in.begin() == '+') {
+			s.pushToken(ast::VarianceType::COVARIANT, LOCATION);
 		} else {
-			PUSH(Token, ast::VarianceType::CONTRAVARIANT);
+			s.pushToken(ast::VarianceType::CONTRAVARIANT, LOCATION);
 		}
 	} END;
 	TOKEN(variadic, ast::VarianceType::VARIADIC);
 	RULE(relation) {
-		if (in.string()[0] == ':') {
-			PUSH(Token, ast::RelationType::IMPLS);
+		if (*in.begin() == ':') {
+			s.pushToken(ast::RelationType::IMPLS, LOCATION);
 		} else {
-			PUSH(Token, ast::RelationType::NOT_IMPLS);
+			s.pushToken(ast::RelationType::NOT_IMPLS, LOCATION);
 		}
 	} END;
 	RULE(error_gentyp) {
@@ -574,16 +586,16 @@ namespace spero::parser::actions {
 	RULE(default_type) {
 		// stack: bind var var? type
 		auto def_type = POP(Type);
-		auto variadic = POP(Token);
-		auto variance = POP(Token);
+		auto variadic = s.popToken();
+		auto variance = s.popToken();
 
 		if (!variance) {
 			std::swap(variance, variadic);
 		}
 
 		PUSH(TypeGeneric, POP(BasicBinding), std::move(def_type));
-		util::viewAs<ast::TypeGeneric>(s.back())->variance = variance->get<ast::VarianceType>();
-		util::viewAs<ast::TypeGeneric>(s.back())->variadic = (bool)variadic;
+		s.view<ast::TypeGeneric>()->variance = variance->get<ast::VarianceType>();
+		s.view<ast::TypeGeneric>()->variadic = (bool)variadic;
 		// stack: type_gen
 	} END;
 	RULE(related_type) {
@@ -594,11 +606,11 @@ namespace spero::parser::actions {
 		}
 
 		auto typ = POP(Type);
-		auto rel = (typ || err) ? POP(Token)->get<ast::RelationType>() : ast::RelationType::NA;
-		auto variadic = POP(Token);
-		auto variance = POP(Token);
+		auto rel = (typ || err) ? s.popToken()->get<ast::RelationType>() : ast::RelationType::NA;
+		auto variadic = s.popToken();
+		auto variance = s.popToken();
 
-		// If no variadic was given, then variance will take on "nullptr" due to the stack popping
+		// If no variadic was given, then variance will be empty due to the stack popping
 		if (!variance) {
 			std::swap(variance, variadic);
 		}
@@ -618,7 +630,7 @@ namespace spero::parser::actions {
 		}
 
 		auto typ = POP(Type);
-		auto rel = (typ || err) ? POP(Token)->get<ast::RelationType>() : ast::RelationType::NA;
+		auto rel = (typ || err) ? s.popToken()->get<ast::RelationType>() : ast::RelationType::NA;
 
 		PUSH(ValueGeneric, POP(BasicBinding), std::move(typ), rel);
 		// stack: val_gen
@@ -637,15 +649,15 @@ namespace spero::parser::actions {
 		// stack:
 	} END;
 	RULE(gen_parterror) {
-		state.log(compiler::ID::err, "Unexpected input: Could not match spero generic \"{}\" <gen_part {}>", in.string(), LOCATION);
+		state.log(compiler::ID::err, "Unexpected input: Could not match spero generic \"{}\" <gen_part {}>", IN_VIEW, LOCATION);
 	} END;
 	RULE(_generic) {
 		// stack: {} gen_part* error?
 		auto err = POP(CloseSymbolError);
-		auto parts = util::popSeq<ast::GenericPart>(s);
+		auto parts = s.popFrame<ast::GenericPart>();
 
 		// Error Handling
-		auto sym = POP(Symbol);
+		auto sym = s.popSymbol();
 		if (err) {
 			state.log(compiler::ID::err, "No closing parenthesis found for opening '[' <generic at {}>", sym->loc);
 		}
@@ -657,8 +669,8 @@ namespace spero::parser::actions {
 		// stack: typ sym? type?
 		auto typ_args = POP(TupleType);
 		
-		if (POP(Symbol)) {
-			state.log(compiler::ID::err, "Missing expected tuple types indicated by opening '(' <adt at {}>", s.back()->loc);
+		if (s.popSymbol()) {
+			state.log(compiler::ID::err, "Missing expected tuple types indicated by opening '(' <adt at {}>", s.loc());
 		}
 
 		PUSH(Adt, POP(BasicBinding), std::move(typ_args));
@@ -687,10 +699,10 @@ namespace spero::parser::actions {
 	RULE(arg_tuple) {
 		// stack: {} arg* error?
 		auto err = POP(CloseSymbolError);
-		auto args = util::popSeq<ast::Argument>(s);
+		auto args = s.popFrame<ast::Argument>();
 
 		// Error Handling
-		auto sym = POP(Symbol);
+		auto sym = s.popSymbol();
 		if (err) {
 			state.log(compiler::ID::err, "No closing parenthesis found for opening '(' <arg_tuple at {}>", sym->loc);
 		}
@@ -706,29 +718,29 @@ namespace spero::parser::actions {
 	RULE(missing_in) {
 		// stack: "for" pattern | error
 		POP(Pattern);
-		auto key = POP(Token);
+		auto key = s.popToken();
 		state.log(compiler::ID::err, "Missing keyword `in` <for loop at {}>", key->loc);
 		PUSH_NODE(ValError);
 		// stack: 
 	} END;
 	RULE(missing_gen) {
 		// stack: "for" _
-		auto loc = (*(s.rbegin() + 1))->loc;
+		auto loc = s.loc(1);
 		state.log(compiler::ID::err, "Missing loop generator expression <for at {}>", loc);
 		PUSH_NODE(ValError);
 		// stack: "for" _ error
 	} END;
 	RULE(missing_fbody) {
 		// stack: "for" _ _
-		auto loc = (*(s.rbegin() + 2))->loc;
+		auto loc = s.loc(2);
 		state.log(compiler::ID::err, "Missing loop body expression <for at {}>", loc);
 		PUSH_NODE(ValError);
 		// stack: "for" _ _ error
 	} END;
 	RULE(missing_pat) {
 		// stack: "for" _
-		POP(Token);						// Pop extraneous token from failed capture_desc
-		auto loc = POP(Token)->loc;
+		s.popToken();						// Pop extraneous token from failed capture_desc
+		auto loc = s.popToken()->loc;
 		state.log(compiler::ID::err, "Missing decomoposition pattern <for at {}>", loc);
 		PUSH_NODE(ValError);			// Push ValError to represent failed 'for' parsing (grammar skips the rest if this action is run)
 		// stack: error
@@ -738,7 +750,7 @@ namespace spero::parser::actions {
 		auto body = POP(ValExpr);
 		auto generator = POP(ValExpr);
 		auto pat = POP(Pattern);
-		POP(Token);
+		s.popToken();
 
 		// Push the completed for loop only if every sub-part completed successfully
 		if (!util::isType<ast::ValError>(body) && !util::isType<ast::ValError>(generator)) {
@@ -756,7 +768,7 @@ namespace spero::parser::actions {
 	} END;
 	RULE(missing_wbody) {
 		// stack: _
-		auto loc = (*s.rbegin())->loc;
+		auto loc = s.loc();
 		state.log(compiler::ID::err, "Missing loop body expression <while at {}>", loc);
 		PUSH_NODE(ValError);
 		// stack: _ error
@@ -782,7 +794,7 @@ namespace spero::parser::actions {
 	} END;
 	RULE(loop) {
 		// stack: valexpr | error
-		if (!util::atNode<ast::ValError>(s)) {
+		if (!s.at<ast::ValError>()) {
 			PUSH(Loop, POP(ValExpr));
 		}
 		// stack: loop | error
@@ -824,21 +836,21 @@ namespace spero::parser::actions {
 	} END;
 	RULE(branch) {
 		// stack: IfBranch* (valexpr | error)?
-		auto _else_ = (util::atNode<ast::IfBranch>(s) ? nullptr : POP(ValExpr));
-		auto ifs = util::popSeq<ast::IfBranch>(s);
+		auto _else_ = (s.at<ast::IfBranch>() ? nullptr : POP(ValExpr));
+		auto ifs = s.popSeq<ast::IfBranch>();
 		PUSH(IfElse, std::move(ifs), std::move(_else_));
 		// stack: IfElse
 	} END;
 	RULE(missing_arrow) {
 		// stack: pat _
 		// TODO: Find the pattern, not just the if_core
-		auto loc = (*s.rbegin())->loc;
+		auto loc = s.loc();
 		state.log(compiler::ID::err, "Missing arrow keyword ('=>') <case at {}>", loc);
 		// stack: pat _
 	} END;
 	RULE(case_pat) {
 		// stack: <T> pattern*
-		auto pats = util::popSeq<ast::Pattern>(s);
+		auto pats = s.popSeq<ast::Pattern>();
 		PUSH(TuplePattern, std::move(pats));
 		// stack: <T> pattern
 	} END;
@@ -848,7 +860,7 @@ namespace spero::parser::actions {
 	} END;
 	RULE(missing_cpat) {
 		// stack: _
-		auto loc = POP(Token)->loc;
+		auto loc = s.popToken()->loc;
 		state.log(compiler::ID::err, "Missing continued pattern indicated by ',' <case at {}>", loc);
 		// stack:
 	} END;
@@ -863,23 +875,23 @@ namespace spero::parser::actions {
 		// stack: 
 		state.log(compiler::ID::err, "Missing match switch expression <match at {}>", LOCATION);
 		PUSH_NODE(ValError);
-		PUSH(Symbol, '{');				// Push symbol on the stack for reporting of match errors
+		s.pushSymbol('{', LOCATION);				// Push symbol on the stack for reporting of match errors
 		// stack: error
 	} END;
 	RULE(missing_brace) {
 		// stack: _
-		state.log(compiler::ID::err, "Missing opening brace '{}' <match at {}>", '{', s.back()->loc);
-		PUSH(Symbol, '{');
+		state.log(compiler::ID::err, "Missing opening brace '{}' <match at {}>", '{', s.loc());
+		s.pushSymbol('{', LOCATION);
 		// stack: _ error
 	} END;
 	RULE(matchs) {
 		// stack: valexpr {} case+ keyword error?
 		auto err = POP(CloseSymbolError);
-		POP(Token);
-		auto cases = util::popSeq<ast::Case>(s);
+		s.popToken();
+		auto cases = s.popFrame<ast::Case>();
 
 		// Error Handling
-		auto sym = POP(Symbol);
+		auto sym = s.popSymbol();
 		if (err) {
 			state.log(compiler::ID::err, "No closing brace found for opening '{}' <match at {}>", '{', sym->loc);
 		}
@@ -893,7 +905,7 @@ namespace spero::parser::actions {
 	RULE(jump) {
 		// stack: kwd expr?
 		auto expr = POP(ValExpr);
-		PUSH(Jump, POP(Token)->get<ast::KeywordType>(), std::move(expr));
+		PUSH(Jump, s.popToken()->get<ast::KeywordType>(), std::move(expr));
 		// stack: jump
 	} END;
 	INHERIT(dotloop, loop);
@@ -911,8 +923,8 @@ namespace spero::parser::actions {
 	} END;
 	RULE(missing_dotpat) {
 		// stack: body "for" _
-		POP(Token);						// Pop off extraneous token from capture_desc
-		POP(Token);
+		s.popToken();						// Pop off extraneous token from capture_desc
+		s.popToken();
 		auto loc = POP(ValExpr)->loc;
 		state.log(compiler::ID::err, "Missing decomoposition pattern <for at {}>", loc);
 		PUSH_NODE(ValError);
@@ -922,7 +934,7 @@ namespace spero::parser::actions {
 		// stack: body "for" pattern (gen | error)
 		auto generator = POP(ValExpr);
 		auto pattern = POP(Pattern);
-		POP(Token);
+		s.popToken();
 
 		if (!util::isType<ast::ValError>(generator)) {
 			PUSH(For, std::move(pattern), std::move(generator), POP(ValExpr));
@@ -942,7 +954,7 @@ namespace spero::parser::actions {
 	INHERIT(dotmatch, matchs);
 	RULE(dotjump) {
 		// stack: expr kwd
-		auto tkn = POP(Token)->get<ast::KeywordType>();
+		auto tkn = s.popToken()->get<ast::KeywordType>();
 		PUSH(Jump, tkn, POP(ValExpr));
 		// stack: jump
 	} END;
@@ -959,16 +971,16 @@ namespace spero::parser::actions {
 	} END;
 	RULE(pathed_var) {
 		// stack: path | var
-		if (util::atNode<ast::Path>(s)) {
-			auto loc = s.back()->loc;
-			s.emplace_back(std::make_unique<ast::Variable>(POP(Path), loc));
+		if (s.at<ast::Path>()) {
+			auto loc = s.loc();
+			s.push(std::make_unique<ast::Variable>(POP(Path), loc));
 		}
 		// stack: var
 	} END;
 	RULE(op_var) {
 		// stack: binding
 		auto bind = POP(BasicBinding);
-		s.emplace_back(std::make_unique<ast::Path>(std::make_unique<ast::PathPart>(bind->name, ast::BindingType::OPERATOR, bind->loc), bind->loc));
+		s.push(std::make_unique<ast::Path>(std::make_unique<ast::PathPart>(bind->name, ast::BindingType::OPERATOR, bind->loc), bind->loc));
 		action<grammar::pathed_var>::apply(in, s, state);
 		// stack: var
 	} END;
@@ -987,17 +999,16 @@ namespace spero::parser::actions {
 	} END;
 	RULE(indexeps) {
 		// stack: expr
-		s.emplace_back(nullptr);
-		std::iter_swap(std::rbegin(s), std::rbegin(s) + 1);
+		s.openFrame(LOCATION);
 		// stack: {} expr
 	} END;
 	RULE(missing_fncall) {
-		state.log(compiler::ID::err, "Missing fncall indicated by opening '.' <index at {}>", s.back()->loc);
+		state.log(compiler::ID::err, "Missing fncall indicated by opening '.' <index at {}>", s.loc());
 		PUSH_NODE(ValError);
 	} END;
 	RULE(index_cont) {
 		// stack: {} expr*
-		auto exprs = util::popSeq<ast::ValExpr>(s);
+		auto exprs = s.popFrame<ast::ValExpr>();
 		s.pop_back();
 		PUSH(Index, std::move(exprs));
 		// stack: index
@@ -1006,7 +1017,7 @@ namespace spero::parser::actions {
 		auto val = POP(ValExpr);
 		s.pop_back();						// Pop leftover (TODO: ?) from the stack
 		state.log(compiler::ID::err, "Missing index/dot_ctrl indicated by opening '.' <index at {}>", val->loc);
-		s.emplace_back(std::move(val));
+		s.push(std::move(val));
 	} END;
 	RULE(unopcall) {
 		// stack: bind expr
@@ -1018,7 +1029,7 @@ namespace spero::parser::actions {
 	} END;
 	RULE(missing_unexpr) {
 		// stack: bind
-		state.log(compiler::ID::err, "Missing valexpr body indicated by unary operator <unop at {}>", s.back()->loc);
+		state.log(compiler::ID::err, "Missing valexpr body indicated by unary operator <unop at {}>", s.loc());
 		PUSH_NODE(ValError);
 		// stack: bind error
 	} END;
@@ -1045,7 +1056,7 @@ namespace spero::parser::actions {
 		// stack: ModDec
 	} END;
 	RULE(missing_fortype) {
-		state.log(compiler::ID::err, "Missing implementor type <impl at {}>", s.back()->loc);
+		state.log(compiler::ID::err, "Missing implementor type <impl at {}>", s.loc());
 		PUSH_NODE(TypeError);
 	} END;
 	TOKEN(for_type, ast::KeywordType::FOR);
@@ -1054,23 +1065,23 @@ namespace spero::parser::actions {
 		PUSH_NODE(TypeError);
 	} END;
 	RULE(missing_impldef) {
-		state.log(compiler::ID::err, "Missing implementation body <impl at {}>", s.back()->loc);
+		state.log(compiler::ID::err, "Missing implementation body <impl at {}>", s.loc());
 		PUSH_NODE(ScopeError);
 	} END;
 	RULE(impl) {
 		// stack: type (type "for")? scope
 		auto block = POP(Block);
-		auto for_type = (POP(Token) ? POP(SourceType) : nullptr);
+		auto for_type = (s.popToken() ? POP(SourceType) : nullptr);
 		PUSH(ImplExpr, std::move(for_type), POP(SourceType), std::move(block));
 		// stack: impl
 	} END;
 	RULE(mul_imp) {
 		// stack: path {} PathPart* error?
 		auto err = POP(CloseSymbolError);
-		auto bindings = util::popSeq<ast::PathPart>(s);
+		auto bindings = s.popFrame<ast::PathPart>();
 
 		// Error Handling
-		auto sym = POP(Symbol);
+		auto sym = s.popSymbol();
 		if (err) {
 			state.log(compiler::ID::err, "No closing brace found for opening '{}' <mul_imp at {}>", '{', sym->loc);
 		}
@@ -1093,10 +1104,10 @@ namespace spero::parser::actions {
 	} END;
 	RULE(err_rebind) {
 		// stack: Path {}
-		POP(Token);
-		auto loc = util::viewAs<ast::Path>(s.back())->loc;
+		s.popToken();
+		auto loc = s.view<ast::Path>()->loc;
 
-		state.log(compiler::ID::err, "Cannot rebind symbol as `{}` <at {}>", *util::viewAs<ast::Path>(s.back()), loc);
+		state.log(compiler::ID::err, "Cannot rebind symbol as `{}` <at {}>", *s.view<ast::Path>(), loc);
 		PUSH(SingleImport, POP(Path));
 		// stack: Path
 	} END;
@@ -1111,40 +1122,40 @@ namespace spero::parser::actions {
 	} END;
 	RULE(missing_typedef) {
 		// stack: vis pat gen? mut? cons*
-		state.log(compiler::ID::err, "Missing type definition body <type_assign at {}>", s.back()->loc);
+		state.log(compiler::ID::err, "Missing type definition body <type_assign at {}>", s.loc());
 		PUSH_NODE(ScopeError);
 		// stack: vis pat gen? mut? cons* error
 	} END;
 	RULE(missing_type_assign) {
 		// stack: vis pat gen?
-		state.log(compiler::ID::err, "Missing assignment operator '=' <type_assign at {}>", s.back()->loc);
+		state.log(compiler::ID::err, "Missing assignment operator '=' <type_assign at {}>", s.loc());
 		PUSH_NODE(ScopeError);
 		// stack: vis pat gen? error
 	} END;
 	RULE(type_assign) {
 		// stack: vis pat gen? "mut"? cons* scope
 		auto body = POP(Block);
-		auto cons = util::popSeq<ast::Constructor>(s);
-		auto mut = POP(Token) != nullptr;
+		auto cons = s.popSeq<ast::Constructor>();
+		auto mut = s.popToken().has_value();
 		auto gen = POP(GenericArray);
 		auto pat = POP(AssignPattern);
 
 		PUSH(TypeAssign,
-			POP(Token)->get<ast::VisibilityType>(),
+			s.popToken()->get<ast::VisibilityType>(),
 			std::move(pat), std::move(gen), mut,
 			std::move(cons), std::move(body));
 		// stack: TypeAssign
 	} END;
 	RULE(asgn_val) {
 		// stack: (vis pat gen? type? val) | in
-		if (!util::atNode<ast::InAssign>(s)) {
+		if (!s.at<ast::InAssign>()) {
 			auto val = POP(ValExpr);
 			auto typ = POP(Type);
 			auto gen = POP(GenericArray);
 			auto pat = POP(AssignPattern);
 
 			PUSH(VarAssign,
-				POP(Token)->get<ast::VisibilityType>(),
+				s.popToken()->get<ast::VisibilityType>(),
 				std::move(pat), std::move(gen),
 				std::move(typ), std::move(val));
 		}
@@ -1152,33 +1163,33 @@ namespace spero::parser::actions {
 	} END;
 	RULE(missing_invexpr) {
 		// stack: vis pat gen? type? val
-		state.log(compiler::ID::err, "Missing bound scoped expression <in_asign at {}>", s.back()->loc);
+		state.log(compiler::ID::err, "Missing bound scoped expression <in_asign at {}>", s.loc());
 		PUSH_NODE(ValError);
 		// stack: vis pat gen? type? val error
 	} END;
 	RULE(missing_asexpr) {
 		// stack: vis pat gen? type?
-		state.log(compiler::ID::err, "Missing assignment value expression <in_asign at {}>", s.back()->loc);
+		state.log(compiler::ID::err, "Missing assignment value expression <in_asign at {}>", s.loc());
 		PUSH_NODE(ValError);
 		PUSH_NODE(ValError);
 		// stack: vis pat gen? type? error error
 	} END;
 	RULE(missing_inexpr) {
 		// stack: vis pat gen? type? val
-		state.log(compiler::ID::err, "Missing scoping operator 'in' <in_asign at {}>", s.back()->loc);
+		state.log(compiler::ID::err, "Missing scoping operator 'in' <in_asign at {}>", s.loc());
 		PUSH_NODE(ValError);
 		// stack: vis pat gen? type? val error
 	} END;
 	RULE(missing_assignment) {
 		// stack: vis pat gen? type?
-		state.log(compiler::ID::err, "Missing assignment operator '=' <in_asign at {}>", s.back()->loc);
+		state.log(compiler::ID::err, "Missing assignment operator '=' <in_asign at {}>", s.loc());
 		PUSH_NODE(ValError);
 		PUSH_NODE(ValError);
 		// stack: vis pat gen? type? error error
 	} END;
 	RULE(missing_aspat) {
 		// stack: vis
-		state.log(compiler::ID::err, "Missing decomoposition pattern <in_asign at {}>", POP(Token)->loc);
+		state.log(compiler::ID::err, "Missing decomoposition pattern <in_asign at {}>", s.popToken()->loc);
 		PUSH_NODE(ValError);
 		// stack: error
 	} END;
@@ -1192,19 +1203,19 @@ namespace spero::parser::actions {
 	INHERIT(asgn_in, _in_assign);
 	RULE(_interface) {
 		// stack: (vis pat gen? type) | varasgn
-		if (!util::atNode<ast::VarAssign>(s)) {
+		if (!s.at<ast::VarAssign>()) {
 			auto typ = POP(Type);
 			auto gen = POP(GenericArray);
 			auto pat = POP(AssignPattern);
 			PUSH(Interface,
-				POP(Token)->get<ast::VisibilityType>(),
+				s.popToken()->get<ast::VisibilityType>(),
 				std::move(pat), std::move(gen), std::move(typ));
 		}
 		// stack: Interface | VarAssign
 	} END;
 	RULE(missing_val_assign) {
 		// stack:
-		state.log(compiler::ID::err, "Missing assignment value expression <val_assign at {}>", s.back()->loc);
+		state.log(compiler::ID::err, "Missing assignment value expression <val_assign at {}>", s.loc());
 		PUSH_NODE(ValError);
 		// stack: error
 	} END;
@@ -1212,13 +1223,13 @@ namespace spero::parser::actions {
 		// stack: vis pat gen?
 		POP(GenericArray);
 		POP(AssignPattern);
-		state.log(compiler::ID::err, "Missing interface/assignment indicated by varname <val_assign at {}>", POP(Token)->loc);
+		state.log(compiler::ID::err, "Missing interface/assignment indicated by varname <val_assign at {}>", s.popToken()->loc);
 		PUSH_NODE(ValError);
 		// stack: error
 	} END;
 	RULE(standalone_visibility) {
 		// stack: vis
-		state.log(compiler::ID::err, "Missing definition indicated by visibility <assign at {}>", POP(Token)->loc);
+		state.log(compiler::ID::err, "Missing definition indicated by visibility <assign at {}>", s.popToken()->loc);
 		PUSH_NODE(ValError);
 		// stack: error
 	} END;
@@ -1254,11 +1265,11 @@ namespace spero::parser::actions {
 
 	// Organizational Tagging
 	RULE(missing_valexpr) {
-		state.log(compiler::ID::err, "Missing valexpr expression indicated by 'mut' keyword <valexpr at {}>", POP(Token)->loc);
+		state.log(compiler::ID::err, "Missing valexpr expression indicated by 'mut' keyword <valexpr at {}>", s.popToken()->loc);
 		PUSH_NODE(ValError);
 	} END;
 	RULE(missing_valexpr2) {
-		POP(Token);
+		s.popToken();
 		state.log(compiler::ID::err, "Missing valexpr expression indicated by 'do' keyword <valexpr at {}>", LOCATION);
 		PUSH_NODE(ValError);
 	} END;
@@ -1267,12 +1278,12 @@ namespace spero::parser::actions {
 		auto inf = POP(Type);
 		auto expr = POP(ValExpr);
 
-		expr->is_mut = (bool)POP(Token);
+		expr->is_mut = s.popToken().has_value();
 
 		if (inf) {
 			PUSH(TypeAnnotation, std::move(expr), std::move(inf));
 		} else {
-			s.emplace_back(std::move(expr));
+			s.push(std::move(expr));
 		}
 		// stack: expr | typeannot
 	} END;
@@ -1286,12 +1297,16 @@ namespace spero::parser::actions {
 	RULE(statement) {
 		// stack: annotation* stmt
 		auto stmt = POP(Statement);
-		auto anots = util::popSeq<ast::LocalAnnotation>(s);
+		auto anots = s.popSeq<ast::LocalAnnotation>();
 
 		stmt->annots = std::move(anots);
-		s.emplace_back(std::move(stmt));
+		s.push(std::move(stmt));
 		// stack: stmt
 	} END;
+	RULE(top_annotated) {
+		// Forward the completed statement downstream (if streaming)
+		s.flush();
+	} END;
 
 
 	// Errors
@@ -1306,7 +1321,7 @@ namespace spero::parser::actions {
 		PUSH_NODE(Error);
 	} END;
 	RULE(leftovers) {
-		state.log(compiler::ID::err, "Unexpected input: Could not match spero expression \"{}\" <at {}>", in.string(), LOCATION);
+		state.log(compiler::ID::err, "Unexpected input: Could not match spero expression \"{}\" <at {}>", IN_VIEW, LOCATION);
 	} END;
 
 }
@@ -26,7 +26,6 @@ namespace spero::compiler::ast {
 	/*
 	 * Enums and other basic types
 	 */
-	using Sentinel = nullptr_t;
 	BETTER_ENUM(KeywordType, char, LET, DEF, STATIC, MUT, DO,
 		MOD, USE, MATCH, IF, ELSIF, ELSE, WHILE, FOR, LOOP,
 		BREAK, CONT, YIELD, RET, WAIT, IMPL, F_IN, AS)
@@ -52,7 +51,8 @@ namespace spero::compiler::ast {
 	//
 
 	/*
-	 * Base class for representing a token during parsing on the stack
+	 * Base class for representing a token that was left on the stack after parsing
+	 *   NOTE: Tokens are stored inline on the `parser::ParseStack` during parsing
 	 *
 	 * Extends: Ast
 	 *
@@ -124,14 +124,9 @@ namespace spero::compiler::ast {
 	 * Exports:
 	 *   is_mut - flag whether the produced value is mutable
 	 *   unop   - token for any unary operations applied
-	 *   type   - the marked type for the expression
-	 *
-	 * TODO:
-	 *   type will need to be changed in the future to reduce luggage
 	 */
 	struct ValExpr : Statement {
 		bool is_mut = false;
-		std::shared_ptr<analysis::Type> type = nullptr;
 
 		ValExpr(Location loc);
 
@@ -182,7 +177,7 @@ namespace spero::compiler::ast {
 
 	struct Byte : Literal {
 		unsigned long val;
-		Byte(const std::string& val, int base, Location loc);
+		Byte(unsigned long val, Location loc);
 
 		virtual void accept(AstVisitor& v);
 		virtual std::ostream& prettyPrint(std::ostream& s, size_t buf, std::string_view context = "") final;
@@ -190,7 +185,7 @@ namespace spero::compiler::ast {
 
 	struct Float : Literal {
 		double val;
-		Float(const std::string& num, Location loc);
+		Float(double num, Location loc);
 
 		virtual void accept(AstVisitor& v);
 		virtual std::ostream& prettyPrint(std::ostream& s, size_t buf, std::string_view context = "") final;
@@ -198,7 +193,7 @@ namespace spero::compiler::ast {
 
 	struct Int : Literal {
 		long val;
-		Int(const std::string& num, Location loc);
+		Int(long num, Location loc);
 
 		virtual void accept(AstVisitor& v);
 		virtual std::ostream& prettyPrint(std::ostream& s, size_t buf, std::string_view context = "") final;
@@ -269,13 +264,8 @@ namespace spero::compiler::ast {
 	 *   NOTE: The ordering property may depend on context (ie. in regards to types)
 	 *
 	 * Extends: Sequence<Statement, ValExpr>
-	 *
-	 * Exports:
-	 *   locals - a symbol table collecting analysed information about locally declared variables
 	 */
 	struct Block : Sequence<Statement, ValExpr> {
-		opt_t<analysis::SymIndex> locals = std::nullopt;
-
 		Block(std::deque<ptr<Statement>> vals, Location loc);
 
 		virtual void accept(AstVisitor& v);
@@ -297,7 +287,6 @@ namespace spero::compiler::ast {
 	struct Function : ValExpr {
 		std::deque<ptr<Argument>> args;
 		ptr<Block> body;
-		std::optional<spero::String> name;
 
 		Function(std::deque<ptr<Argument>> args, ptr<Block> body, Location loc);
 
@@ -348,8 +337,6 @@ namespace spero::compiler::ast {
 		spero::String name;
 		BindingType type;
 		ptr<Array> gens;
-		opt_t<analysis::SymIndex> sym_index = std::nullopt;
-		opt_t<size_t> ssa_index = std::nullopt;
 
 		PathPart(spero::String str, BindingType type, Location loc);
 
@@ -1224,7 +1211,6 @@ namespace spero::compiler::ast {
 	struct InAssign : ValExpr {
 		ptr<VarAssign> bind;
 		ptr<ValExpr> expr;
-		opt_t<analysis::SymIndex> binding = std::nullopt;
 
 		InAssign(ptr<VarAssign> binding, ptr<ValExpr> expr, Location loc);
 
@@ -1239,11 +1225,9 @@ namespace spero::compiler::ast {
 	 *
 	 * Exports:
 	 *   name - qualified binding that represents the variable
-	 *   def_table - the symbol table which holds the symbol informaton
 	 */
 	struct Variable : ValExpr {
 		ptr<Path> name;
-		opt_t<analysis::SymIndex> def_table = std::nullopt;
 
 		Variable(ptr<Path> symbol, Location loc);
 
@@ -1334,7 +1318,7 @@ namespace spero::compiler::ast {
 	//
 
 	/*
-	 * Helper node for tracking a symbol appearance for error reporting
+	 * Helper node for tracking a symbol appearance that was left on the stack after parsing
 	 *
 	 * Extends: Ast
 	 *
@@ -1392,8 +1376,11 @@ namespace spero::compiler::ast {
 
 namespace spero::analysis {
 
+	struct AnalysisState;
+
 	// If lookup succeeds, then the returned iterator is equal to `std::end(var_path.elems) - 1`
-	std::tuple<SymIndex, compiler::ast::Path::iterator> lookup(SymArena& arena, SymIndex current, compiler::ast::Path& var_path);
+	// If `names` is given, the first path element is resolved through it instead of walking the parent chain of `current`
+	std::tuple<SymIndex, compiler::ast::Path::iterator> lookup(AnalysisState& dict, SymIndex current, compiler::ast::Path& var_path, const ScopedNames* names = nullptr);
 	//bool testSsaLookupFailure(opt_t<SymTable::DataType>& lookup_result, compiler::ast::Path::iterator& iter);
 
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
 
 #include "parser/location.h"
@@ -15,6 +17,43 @@ namespace spero::compiler::ast {
 	 * Forward Declarations and Other types
 	 */
 	struct AstVisitor;
+	using NodeId = uint32_t;
+
+	/*
+	 * Allocates the ids of the nodes created for a compilation, so its analysis tables stay dense
+	 *   Nodes may be created by several parsing threads at once
+	 *
+	 * Exports:
+	 *   next - allocate a fresh id
+	 *   reset - start numbering from 0 again, once none of the numbered nodes are alive (ie. between repl inputs)
+	 */
+	class NodeIds {
+		std::atomic<NodeId> next_id{ 0 };
+
+		public:
+			NodeId next();
+			void reset();
+	};
+
+	// Get the ids that nodes created on this thread are numbered from
+	//   Defaults to process-wide ids if no `NodeIdScope` is active
+	NodeIds& currentIds();
+
+	/*
+	 * Install the ids as the current ids for this thread until the scope ends
+	 *   Scopes must live on the stack of the thread they're opened on, as they restore the previous ids when they end
+	 *   Every thread that creates a compilation's nodes (including the main thread) must open a scope for its ids
+	 */
+	class NodeIdScope {
+		NodeIds* prev;
+
+		public:
+			explicit NodeIdScope(NodeIds& ids);
+			~NodeIdScope();
+
+			NodeIdScope(const NodeIdScope&) = delete;
+			NodeIdScope& operator=(const NodeIdScope&) = delete;
+	};
 
 	/*
 	 * Base class for all ast nodes
@@ -23,10 +62,12 @@ namespace spero::compiler::ast {
 	 *
 	 * Exports:
 	 *   loc - Structure containing the location data for the node
+	 *   id - Dense identifier assigned on creation (see `NodeIds`), used to key analysis results (see `analysis::AnalysisState`)
 	 *   visit - Polymorphic method to accept a visitor object for iteration
 	 */
 	struct Ast {
 		Location loc;
+		NodeId id;
 
 		Ast(Location loc);
 
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+namespace spero::parser {
+
+	/*
+	 * A slice of the input that starts at a top-level declaration and can be parsed on its own
+	 *   `byte` and `line` give the position of the chunk's first character in the full input
+	 */
+	struct Chunk {
+		std::string_view text;
+		size_t byte;
+		size_t line;
+	};
+
+	/*
+	 * Replacement of the bytes `[begin, end)` of some source with `text`
+	 */
+	struct TextEdit {
+		size_t begin;
+		size_t end;
+		std::string_view text;
+	};
+
+	/*
+	 * The smallest single edit that turns `before` into `after` (ie. when an editor only hands over the new source)
+	 *   The edit's text points into `after`
+	 */
+	TextEdit diffSources(std::string_view before, std::string_view after);
+
+	/*
+	 * Split the input before every `let`, `def`, `mod`, `use` or `impl` that starts in column zero
+	 *   outside of any brackets, strings, or comments (along with the annotations directly above it)
+	 *
+	 * NOTE: The first chunk always starts at the beginning of the input, even if it isn't a declaration
+	 */
+	std::vector<Chunk> splitAtDeclarations(std::string_view src);
+
+	/*
+	 * Split the input into at most `max_chunks` chunks of roughly equal size
+	 *   Chunks are only cut where `splitAtDeclarations` would cut
+	 *
+	 * NOTE: Inputs that are too small to be worth splitting are returned as a single chunk
+	 */
+	std::vector<Chunk> splitTopLevel(std::string_view src, size_t max_chunks, size_t min_chunk_size = 16 * 1024);
+
+}
@@ -21,6 +21,11 @@ namespace spero::compiler {
 		      byte_in_data{ in_iter.byte_in_line },
 		      source{ std::forward<T>(in_source) }
 		{}
+
+		// Rebuild a location that doesn't point into a parsed buffer (ie. one loaded from a binary ast)
+		inline Location(size_t line_num, size_t byte, std::string source)
+		    : line_num{ line_num }, byte{ byte }, data{ nullptr }, byte_in_data{ byte }, source{ std::move(source) }
+		{}
 	};
 
 	template<class Stream>
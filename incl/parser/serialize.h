@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "parser/ast.h"
+#include "interface/CompilationState.h"
+
+namespace spero::parser {
+
+	/*
+	 * Compact binary encoding of a parsed ast
+	 *   The encoding is a small header, a table of every string the ast uses (names, literals and
+	 *   source files), and then the top-level nodes in pre-order. Every node is stored as its kind,
+	 *   its location (with the source file as a string index), and its fields and children in order
+	 *
+	 * NOTE: Analysis results (symbol table indices, inferred types) are not stored
+	 *
+	 * Exports:
+	 *   serialize - encode the stack into the binary format
+	 *   deserialize - rebuild the stack from an encoded buffer (ie. a mapped file), interning every name
+	 *   isSerializedAst - check whether the buffer starts with a binary ast header
+	 */
+	std::string serialize(const Stack& stack);
+	bool deserialize(std::string_view bytes, Stack& stack);
+	bool isSerializedAst(std::string_view bytes);
+
+}
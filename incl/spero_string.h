@@ -1,17 +1,196 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <ostream>
 #include <string>
-
-#include <boost/flyweight.hpp>
+#include <string_view>
 
 namespace spero {
 
+	class String;
+
 	namespace string {
+		class Interner;
+
 		using backing_type = std::string;
 		using char_type = backing_type::traits_type::char_type;
+		using id_type = std::uint32_t;
+
+		/*
+		 * Storage for a single interned name
+		 *   Entries are immutable once published and live as long as the interner that created them
+		 *   The well known names are shared by every interner, so they have no owner
+		 */
+		struct Entry {
+			backing_type str;
+			std::size_t hash;
+			id_type id;
+			const Interner* owner = nullptr;
+		};
+
+		// FNV-1a, computed once when a name is interned and stored in its `Entry`
+		constexpr std::size_t hashOf(std::string_view str) {
+			std::uint64_t hash = 14695981039346656037ull;
+			for (auto ch : str) {
+				hash = (hash ^ static_cast<unsigned char>(ch)) * 1099511628211ull;
+			}
+			return static_cast<std::size_t>(hash);
+		}
+
+		/*
+		 * Names that are pre-seeded into every interner with fixed ids
+		 *   Use the `names::*` constants instead of constructing these from literals
+		 */
+		enum WellKnown : id_type {
+			EMPTY, SELF, SUPER, INT, BOOL, FLOAT, CHAR, BYTE, STRING, ASSIGN, MAIN, JITFUNC,
+			NUM_WELL_KNOWN
+		};
+
+		namespace detail {
+			extern const Entry well_known[NUM_WELL_KNOWN];
+		}
+
+
+		/*
+		 * Compilation-scoped string interner
+		 *   Lookups of existing names never lock. The table is split into shards, each of which
+		 *   only locks when inserting a new name. Grown tables are retired rather than freed, so
+		 *   concurrent readers never observe freed memory. Everything is reclaimed with the interner
+		 *
+		 * Exports:
+		 *   intern - find or create the entry for the given name
+		 *   size - the number of names interned in this interner (including the well known names)
+		 *
+		 * NOTE: Ids are allocated from a single process-wide counter, so they're unique across interners
+		 */
+		class Interner {
+			static constexpr std::size_t num_shards = 16;
+			static constexpr std::size_t initial_capacity = 64;
+
+			struct Table {
+				std::size_t mask;
+				std::unique_ptr<std::atomic<const Entry*>[]> slots;
+
+				Table(std::size_t capacity);
+			};
+
+			struct Shard {
+				std::atomic<Table*> table;
+				std::mutex insert_lock;
+				std::deque<Table> tables;
+				std::deque<Entry> entries;
+				std::size_t count = 0;
+			};
+
+			std::array<Shard, num_shards> shards;
+			std::atomic<std::size_t> count{ NUM_WELL_KNOWN };
+			static std::atomic<id_type> next_id;
+
+			static const Entry* find(const Table& table, std::string_view str, std::size_t hash);
+			static void insert(Table& table, const Entry* entry);
+			void seed(const Entry& entry);
+
+			public:
+				Interner();
+				Interner(const Interner&) = delete;
+				Interner& operator=(const Interner&) = delete;
+
+				const Entry& intern(std::string_view str);
+				std::size_t size() const;
+		};
+
+		// Get the interner that `String` constructions on this thread are interned in
+		//   Defaults to a process-wide interner if no `InternerScope` is active
+		Interner& current();
+
+		/*
+		 * Install an interner as the current interner for this thread until the scope ends
+		 *   Scopes must live on the stack of the thread they're opened on, as they restore the previous interner when they end
+		 *   Every thread that operates on a compilation's strings (including the main thread) must open a scope for its interner
+		 */
+		class InternerScope {
+			Interner* prev;
+
+			public:
+				explicit InternerScope(Interner& interner);
+				~InternerScope();
+
+				InternerScope(const InternerScope&) = delete;
+				InternerScope& operator=(const InternerScope&) = delete;
+		};
+	}
+
+
+	/*
+	 * Interned string handle
+	 *   Strings from the same interner are equal only if they share an entry
+	 *   Strings from different interners (ie. a static created before a compilation's scope was opened) compare their text
+	 */
+	class String {
+		const string::Entry* entry;
+
+		public:
+			constexpr explicit String(const string::Entry& entry) : entry{ &entry } {}
+			String() : String{ string::detail::well_known[string::EMPTY] } {}
+			String(std::string_view str) : String{ string::current().intern(str) } {}
+			String(const char* str) : String{ std::string_view{ str } } {}
+			String(const string::backing_type& str) : String{ std::string_view{ str } } {}
+
+			inline const string::backing_type& get() const {
+				return entry->str;
+			}
+			inline operator const string::backing_type&() const {
+				return entry->str;
+			}
+			inline string::id_type id() const {
+				return entry->id;
+			}
+			inline std::size_t hash() const {
+				return entry->hash;
+			}
+
+			friend bool operator==(const String& lhs, const String& rhs) {
+				if (lhs.entry == rhs.entry) {
+					return true;
+				}
+				return lhs.entry->owner != rhs.entry->owner && lhs.entry->hash == rhs.entry->hash && lhs.entry->str == rhs.entry->str;
+			}
+			friend bool operator!=(const String& lhs, const String& rhs) { return !(lhs == rhs); }
+			friend bool operator==(const String& lhs, std::string_view rhs) { return lhs.get() == rhs; }
+			friend bool operator!=(const String& lhs, std::string_view rhs) { return lhs.get() != rhs; }
+			friend bool operator==(const String& lhs, const char* rhs) { return lhs.get() == rhs; }
+			friend bool operator!=(const String& lhs, const char* rhs) { return lhs.get() != rhs; }
+			friend bool operator<(const String& lhs, const String& rhs) { return lhs.get() < rhs.get(); }
+
+			friend std::ostream& operator<<(std::ostream& s, const String& str) {
+				return s << str.get();
+			}
+	};
+
+	// Intern the given name
+	inline String intern(std::string_view str) {
+		return String{ str };
 	}
 
-	using String = boost::flyweight<std::string>;
+	namespace string::names {
+		inline const String empty{ detail::well_known[EMPTY] };
+		inline const String self{ detail::well_known[SELF] };
+		inline const String super{ detail::well_known[SUPER] };
+		inline const String Int{ detail::well_known[INT] };
+		inline const String Bool{ detail::well_known[BOOL] };
+		inline const String Float{ detail::well_known[FLOAT] };
+		inline const String Char{ detail::well_known[CHAR] };
+		inline const String Byte{ detail::well_known[BYTE] };
+		inline const String String{ detail::well_known[STRING] };
+		inline const spero::String assign{ detail::well_known[ASSIGN] };
+		inline const spero::String main{ detail::well_known[MAIN] };
+		inline const spero::String jitfunc{ detail::well_known[JITFUNC] };
+	}
 
 }
 
@@ -25,9 +204,8 @@ namespace std {
 		using argument_type = spero::String;
 
 		result_type operator()(const spero::String& x) const {
-			std::hash<const argument_type::value_type*> h;
-			return h(&x.get());
+			return x.hash();
 		}
 	};
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+namespace spero::util {
+
+	/*
+	 * Bounded queue for handing values between threads of a pipeline
+	 *   `push` blocks while the channel is full, providing backpressure to the producer
+	 *   `pop` blocks while the channel is empty, and returns `nullopt` once the channel is closed and drained
+	 */
+	template<class T>
+	class Channel {
+		std::deque<T> values;
+		size_t capacity;
+		bool closed = false;
+
+		std::mutex lock;
+		std::condition_variable not_empty;
+		std::condition_variable not_full;
+
+		public:
+			explicit Channel(size_t capacity) : capacity{ capacity } {}
+
+			void push(T value) {
+				{
+					std::unique_lock<std::mutex> guard{ lock };
+					not_full.wait(guard, [&]() { return values.size() < capacity || closed; });
+					values.push_back(std::move(value));
+				}
+				not_empty.notify_one();
+			}
+
+			std::optional<T> pop() {
+				std::unique_lock<std::mutex> guard{ lock };
+				not_empty.wait(guard, [&]() { return !values.empty() || closed; });
+
+				if (values.empty()) {
+					return std::nullopt;
+				}
+
+				auto ret = std::move(values.front());
+				values.pop_front();
+				guard.unlock();
+
+				not_full.notify_one();
+				return std::move(ret);
+			}
+
+			void close() {
+				{
+					std::lock_guard<std::mutex> guard{ lock };
+					closed = true;
+				}
+				not_empty.notify_all();
+				not_full.notify_all();
+			}
+	};
+
+}
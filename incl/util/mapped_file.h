@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace spero::util {
+
+	/*
+	 * Read-only memory mapping of an entire file
+	 *   The mapping is released when the object is destroyed, so views into `bytes` must not outlive it
+	 *
+	 * Exports:
+	 *   bytes - view of the file's contents (empty if the file couldn't be mapped)
+	 */
+	class MappedFile {
+		const char* data = nullptr;
+		size_t size = 0;
+
+#ifdef _WIN32
+		void* file = nullptr;
+		void* mapping = nullptr;
+#endif
+
+		public:
+			explicit MappedFile(const std::string& path);
+			~MappedFile();
+
+			MappedFile(const MappedFile&) = delete;
+			MappedFile& operator=(const MappedFile&) = delete;
+
+			explicit operator bool() const {
+				return data != nullptr;
+			}
+			std::string_view bytes() const {
+				return { data, size };
+			}
+	};
+
+}
@@ -1,12 +1,36 @@
 #pragma once
 
+#include <charconv>
 #include <deque>
+#include <optional>
+#include <string_view>
 
 #include "spero_string.h"
 
 namespace spero::util {
 
 	std::deque<std::string> split(std::string str, char newline_ch);
-	std::string escape(std::string str);
+	std::string escape(std::string_view str);
+
+	/*
+	 * Convert the number at the start of `str` without copying it
+	 *   Returns `nullopt` if `str` doesn't start with a number or if it doesn't fit in a `T`
+	 */
+	template<class T>
+	std::optional<T> toNumber(std::string_view str, int base = 10) {
+		T val{};
+		std::from_chars_result res;
+
+		if constexpr (std::is_floating_point_v<T>) {
+			res = std::from_chars(str.data(), str.data() + str.size(), val);
+		} else {
+			res = std::from_chars(str.data(), str.data() + str.size(), val, base);
+		}
+
+		if (res.ec != std::errc{}) {
+			return std::nullopt;
+		}
+		return val;
+	}
 	
 }
\ No newline at end of file
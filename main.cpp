@@ -106,6 +106,10 @@ int main(int argc, char* argv[]) {
 	auto opts = cmd::getOptions();
 	auto state = cmd::parse(opts, argc, argv);
 
+	// Names and nodes created on this thread belong to the compilation (worker threads open their own scopes)
+	string::InternerScope strings{ state.strings() };
+	ast::NodeIdScope ids{ state.nodeIds() };
+
 	// Compiler run
 	if (!state.opts["interactive"].as<bool>()) {
 		state.setPermissions(parser::ParsingMode::FILE, true, true, false);
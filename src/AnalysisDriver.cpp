@@ -8,12 +8,32 @@
 #include <llvm/Passes/PassBuilder.h>
 #pragma warning(pop)
 
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
 #include "parser/actions.h"
+#include "parser/chunks.h"
+#include "parser/serialize.h"
+#include "util/mapped_file.h"
+#include "util/channel.h"
+#include "util/parser.h"
 
 // Passes
 #include "analysis/VarDeclPass.h"
 #include "analysis/VarRefPass.h"
 #include "analysis/BasicTypingPass.h"
+#include "analysis/CallGraphPass.h"
+#include "analysis/ConstFoldingPass.h"
+#include "analysis/ArrayPass.h"
+#include "analysis/EffectPass.h"
+#include "analysis/DependencyPass.h"
+#include "analysis/ProgramQueries.h"
+#include "analysis/SubtreePass.h"
 #include "codegen/LlvmIrGenerator.h"
 
 using namespace spero;
@@ -39,7 +59,7 @@ AnalysisDriver::AnalysisDriver(CompilationState& state)
 {
 	// Register the core spero types/etc.
 	// TODO: Replace with more generalized registration code
-	decls.loadModuleTypes(analysis::getCoreTypeList());
+	decls.loadModuleTypes(analysis::getCoreTypeList(decls.types));
 
 	// Link and register all of the optimization passes
 	// TODO: Clean this up a bit
@@ -57,47 +77,761 @@ AnalysisDriver::AnalysisDriver(CompilationState& state)
 }
 
 #define TIMER(name) auto _ = state.timer(name)
-void AnalysisDriver::parseInput(parser::ParsingMode parser_mode, const std::string& input) {
-	TIMER("parsing");
-
-	bool success = false;
+bool AnalysisDriver::parseStack(parser::ParsingMode parser_mode, const std::string& input, ParseStack& stack) {
 	switch (parser_mode) {
 		case parser::ParsingMode::FILE:
-			success = tao::pegtl::parse<grammar::program, actions::action>(tao::pegtl::file_input<>{ input }, ast, state);
-			break;
+			return tao::pegtl::parse<grammar::program, actions::action>(tao::pegtl::file_input<>{ input }, stack, state);
 		case parser::ParsingMode::STRING:
-			success = tao::pegtl::parse<grammar::program, actions::action>(tao::pegtl::string_input<>{ input, "speroc" }, ast, state);
-			break;
+			return tao::pegtl::parse<grammar::program, actions::action>(tao::pegtl::string_input<>{ input, "speroc" }, stack, state);
 		default:
 			state.log(ID::err, "Invalid parsing mode passed to AnalysisDriver::parseInput");
-			success = true;
-			break;
+			return true;
 	}
+}
+
+void AnalysisDriver::parseInput(parser::ParsingMode parser_mode, const std::string& input) {
+	TIMER("parsing");
+
+	if (auto jobs = state.parserThreads(); jobs > 1) {
+		return parseChunks(parser_mode, input, jobs);
+	}
+
+	ParseStack stack;
+	bool success = parseStack(parser_mode, input, stack);
+	stack.moveNodesInto(ast);
 
 	if (!success) {
 		state.log(ID::err, "Error in parsing of input");
 	}
 }
 
+void AnalysisDriver::parseChunks(parser::ParsingMode parser_mode, const std::string& input, size_t jobs) {
+	std::string text, source;
+	switch (parser_mode) {
+		case parser::ParsingMode::FILE: {
+			std::ifstream file{ input, std::ios::binary };
+			if (!file) {
+				state.log(ID::err, "Unable to open input file `{}`", input);
+				return;
+			}
+
+			std::ostringstream contents;
+			contents << file.rdbuf();
+			text = contents.str();
+			source = input;
+			break;
+		}
+		case parser::ParsingMode::STRING:
+			text = input;
+			source = "speroc";
+			break;
+		default:
+			state.log(ID::err, "Invalid parsing mode passed to AnalysisDriver::parseInput");
+			return;
+	}
+
+	auto chunks = parser::splitTopLevel(text, jobs);
+	std::vector<parser::Stack> results(chunks.size());
+	std::vector<char> success(chunks.size(), false);
+
+	// Each chunk is parsed with its position in the full input, so every `Location` stays correct
+	auto parseChunk = [&](size_t i) {
+		string::InternerScope scope{ state.strings() };
+		ast::NodeIdScope ids{ state.nodeIds() };
+		auto& chunk = chunks[i];
+
+		try {
+			ParseStack stack;
+			tao::pegtl::memory_input<> in{ chunk.text.data(), chunk.text.data() + chunk.text.size(), source, chunk.byte, chunk.line, 0 };
+			success[i] = tao::pegtl::parse<grammar::program, actions::action>(in, stack, state);
+			stack.moveNodesInto(results[i]);
+
+		} catch (std::exception& e) {
+			state.log(ID::err, e.what());
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for (size_t i = 1; i < chunks.size(); ++i) {
+		workers.emplace_back(parseChunk, i);
+	}
+	parseChunk(0);
+
+	for (auto& worker : workers) {
+		worker.join();
+	}
+
+	// Stitch the chunks back together in source order
+	for (auto& result : results) {
+		std::move(result.begin(), result.end(), std::back_inserter(ast));
+	}
+
+	if (std::find(success.begin(), success.end(), false) != success.end()) {
+		state.log(ID::err, "Error in parsing of input");
+	}
+}
+
+bool AnalysisDriver::loadAst(const std::string& file) {
+	util::MappedFile mapped{ file };
+	if (!mapped || !parser::isSerializedAst(mapped.bytes())) {
+		return false;
+	}
+
+	TIMER("ast_loading");
+	if (!parser::deserialize(mapped.bytes(), ast)) {
+		state.log(ID::err, "`{}` is not a valid binary ast (it may have been written by a different version of speroc)", file);
+	}
+
+	return true;
+}
+
+void AnalysisDriver::saveAst(const std::string& file) {
+	TIMER("ast_saving");
+
+	std::ofstream out{ file, std::ios::binary };
+	out << parser::serialize(ast);
+
+	if (!out) {
+		state.log(ID::err, "Unable to write the ast to `{}`", file);
+	}
+}
+
+std::string AnalysisDriver::reparseInput(const std::string& old_source, const parser::TextEdit& edit, parser::Stack& replaced) {
+	TIMER("reparsing");
+
+	auto new_source = old_source.substr(0, edit.begin);
+	new_source.append(edit.text);
+	new_source.append(old_source, edit.end, std::string::npos);
+
+	auto delta = static_cast<std::ptrdiff_t>(new_source.size()) - static_cast<std::ptrdiff_t>(old_source.size());
+	auto line_delta = std::count(edit.text.begin(), edit.text.end(), '\n')
+		- std::count(old_source.begin() + edit.begin, old_source.begin() + edit.end, '\n');
+
+	// Find the smallest run of whole statements around the edit that splits the same way in both sources
+	auto old_chunks = parser::splitAtDeclarations(old_source);
+	auto new_chunks = parser::splitAtDeclarations(new_source);
+	auto isOldBoundary = [&](size_t byte) {
+		auto iter = std::lower_bound(old_chunks.begin(), old_chunks.end(), byte, [](auto& chunk, size_t byte) { return chunk.byte < byte; });
+		return iter != old_chunks.end() && iter->byte == byte;
+	};
+
+	auto first = std::upper_bound(new_chunks.begin(), new_chunks.end(), edit.begin, [](size_t byte, auto& chunk) { return byte < chunk.byte; });
+	do {
+		--first;
+	} while (first != new_chunks.begin() && !isOldBoundary(first->byte));
+
+	auto last = first + 1;
+	while (last != new_chunks.end() && (last->byte < edit.begin + edit.text.size() || !isOldBoundary(last->byte - delta))) {
+		++last;
+	}
+
+	auto start = first->byte;
+	auto new_end = (last == new_chunks.end()) ? new_source.size() : last->byte;
+	auto old_end = new_end - delta;
+
+	// Map every top-level node back to its byte offset in the old source
+	std::vector<size_t> line_starts{ 0 };
+	for (size_t i = 0; i != old_source.size(); ++i) {
+		if (old_source[i] == '\n') {
+			line_starts.push_back(i + 1);
+		}
+	}
+
+	std::string source_name = "speroc";
+	size_t offset = 0;
+	parser::Stack before, after;
+	for (auto& node : ast) {
+		// NOTE: Sentinels stay with the statement before them
+		if (node) {
+			offset = line_starts[std::clamp<size_t>(node->loc.line_num, 1, line_starts.size()) - 1] + node->loc.byte;
+			source_name = node->loc.source;
+		}
+
+		if (offset < start) {
+			before.push_back(std::move(node));
+		} else if (offset >= old_end) {
+			after.push_back(std::move(node));
+		} else if (node) {
+			replaced.push_back(std::move(node));
+		}
+	}
+
+	// Parse the edited statements with their position in the full source
+	ParseStack stack;
+	tao::pegtl::memory_input<> in{ new_source.data() + start, new_source.data() + new_end, source_name, start, first->line, 0 };
+	if (!tao::pegtl::parse<grammar::program, actions::action>(in, stack, state)) {
+		state.log(ID::err, "Error in parsing of input");
+	}
+
+	ast = std::move(before);
+	stack.moveNodesInto(ast);
+
+	analysis::SubtreePass shift{ [&](ast::Ast& node) { node.loc.line_num += line_delta; } };
+	for (auto& node : after) {
+		if (node && line_delta != 0) {
+			node->accept(shift);
+		}
+		ast.push_back(std::move(node));
+	}
+
+	return new_source;
+}
+
+void AnalysisDriver::streamInput(parser::ParsingMode parser_mode, const std::string& input) {
+	TIMER("streaming");
+
+	// Bound the number of parsed statements that are waiting on analysis
+	util::Channel<ptr<ast::Ast>> parsed{ 64 };
+
+	std::thread parser{ [&]() {
+		string::InternerScope scope{ state.strings() };
+		ast::NodeIdScope ids{ state.nodeIds() };
+
+		try {
+			ParseStack stack;
+			stack.streamTo([&](ptr<ast::Ast> stmt) { parsed.push(std::move(stmt)); });
+
+			if (!parseStack(parser_mode, input, stack)) {
+				state.log(ID::err, "Error in parsing of input");
+			}
+
+			// Forward anything left behind by error recovery
+			stack.flush();
+
+		} catch (std::exception& e) {
+			state.log(ID::err, e.what());
+		}
+
+		parsed.close();
+	} };
+
+	analysis::VarDeclPass decl_pass{ state, decls };
+	analysis::VarRefPass ref_pass{ state, decls };
+	gen::LlvmIrGenerator generator{ std::move(translation_unit), decls, state };
+	analysis::DependencyPass deps;
+
+	// Statements that are still waiting on some global names to be emitted
+	struct Pending {
+		ptr<ast::Ast> stmt;
+		std::unordered_set<String> declares;
+		size_t missing = 0;
+
+		// The tables opened for the statement's scopes (see `VarDeclPass::openScope`)
+		analysis::SymIndex first_table, last_table;
+	};
+	std::deque<opt_t<Pending>> pending;
+	std::unordered_map<String, std::vector<size_t>> waiters;
+	std::unordered_set<String> emitted{ string::names::self, string::names::super };
+
+	// Emitting a statement may satisfy others, which are queued here instead of being emitted recursively
+	std::deque<size_t> ready;
+
+	// Later statements may still evaluate calls to pure functions at compile time (see `ConstEvaluator`), so those are kept until the end
+	std::vector<Pending> kept;
+	auto isPureFunction = [&](ast::Ast& stmt) {
+		auto* var = dynamic_cast<ast::VarAssign*>(&stmt);
+		auto* fn = var ? util::viewAs<ast::Function>(var->expr) : nullptr;
+		auto effect = fn ? decls.effect_of.at(fn->id) : std::nullopt;
+		return effect && *effect == +analysis::Effect::PURE;
+	};
+
+	// Symbols outlive the statement that declared them, so they can't keep pointing into it once it's freed
+	auto forget = [&](Pending& entry) {
+		auto clear = [](analysis::SymbolInfo& info) { info.definition = nullptr; };
+		for (auto table = entry.first_table; table != entry.last_table; ++table) {
+			decls.arena[table].forEachDefinition(clear);
+		}
+
+		// Global names may also be declared by other statements, which still need their definitions
+		auto* var = dynamic_cast<ast::VarAssign*>(entry.stmt.get());
+		auto* type = dynamic_cast<ast::TypeAssign*>(entry.stmt.get());
+		ast::Ast* definition = var ? static_cast<ast::Ast*>(var->expr.get()) : type ? type->body.get() : nullptr;
+
+		for (auto& name : entry.declares) {
+			if (auto symbols = decls.arena[analysis::GLOBAL_SYM_INDEX].get(name)) {
+				symbols->get().forEachDefinition([&](analysis::SymbolInfo& info) {
+					if (info.definition == definition) {
+						clear(info);
+					}
+				});
+			}
+		}
+	};
+
+	// Run the remaining passes over a batch of statements that are ready, then drop them
+	auto emit = [&](const std::vector<size_t>& ids) {
+		std::vector<Pending> batch;
+		std::vector<ast::Ast*> stmts;
+		for (auto id : ids) {
+			batch.push_back(std::move(*pending[id]));
+			pending[id] = std::nullopt;
+			stmts.push_back(batch.back().stmt.get());
+		}
+
+		// Calls into earlier batches can't be resolved anymore, so the call graph only needs this batch
+		decls.calls = analysis::CallGraph{};
+		if (!state.failed()) {
+			analyzeStatements(ref_pass, stmts);
+		}
+		if (!state.failed()) {
+			translateStatements(generator, stmts, false);
+		}
+
+		for (auto& entry : batch) {
+			for (auto& name : entry.declares) {
+				if (!emitted.insert(name).second) {
+					continue;
+				}
+
+				auto iter = waiters.find(name);
+				if (iter == waiters.end()) {
+					continue;
+				}
+
+				for (auto waiter : iter->second) {
+					if (pending[waiter] && --pending[waiter]->missing == 0) {
+						ready.push_back(waiter);
+					}
+				}
+				waiters.erase(iter);
+			}
+
+			if (isPureFunction(*entry.stmt)) {
+				kept.push_back(std::move(entry));
+			} else {
+				forget(entry);
+				entry.stmt.reset();
+			}
+		}
+	};
+
+	while (auto stmt = parsed.pop()) {
+		if (!*stmt) {
+			continue;
+		}
+
+		auto first_table = decls.arena.size();
+		if (!state.failed()) {
+			(*stmt)->accept(decl_pass);
+		}
+		deps.collect(**stmt);
+
+		auto id = pending.size();
+		auto& entry = pending.emplace_back(Pending{ std::move(*stmt), std::move(deps.declared), 0, first_table, decls.arena.size() });
+
+		for (auto& name : deps.required) {
+			if (emitted.count(name) == 0) {
+				waiters[name].push_back(id);
+				++entry->missing;
+			}
+		}
+
+		if (entry->missing == 0) {
+			ready.push_back(id);
+		}
+
+		while (!ready.empty()) {
+			auto next = ready.front();
+			ready.pop_front();
+			emit({ next });
+		}
+	}
+
+	parser.join();
+
+	// Anything still waiting depends on a name that was never declared, or on a cycle (ie. mutually recursive functions)
+	// Those are emitted together in source order, so cycles are analyzed as a whole and the passes report any actual problem
+	std::vector<size_t> stuck;
+	for (size_t id = 0; id != pending.size(); ++id) {
+		if (pending[id]) {
+			stuck.push_back(id);
+		}
+	}
+	if (!stuck.empty()) {
+		emit(stuck);
+	}
+
+	for (auto& entry : kept) {
+		forget(entry);
+	}
+
+	translation_unit = generator.finalize();
+}
+
 #define RUN_PASS(PassType, ...) { PassType pass { __VA_ARGS__ }; ast::visit(pass, ast); }
 
+// Error recovery may leave empty slots in the ast
+static std::vector<ast::Ast*> statementsOf(parser::Stack& ast) {
+	std::vector<ast::Ast*> stmts;
+	for (auto& node : ast) {
+		if (node) {
+			stmts.push_back(node.get());
+		}
+	}
+
+	return stmts;
+}
+
+AnalysisDriver::ProgramChanges AnalysisDriver::updateProgramQueries() {
+	ProgramChanges changes;
+	auto record = [&](const analysis::StatementNames::Value& names) {
+		changes.names.insert(names.declared.begin(), names.declared.end());
+		changes.names.insert(names.arguments.begin(), names.arguments.end());
+	};
+
+	std::vector<ast::NodeId> stmts;
+	std::unordered_set<ast::NodeId> current;
+	for (auto& node : ast) {
+		if (node) {
+			stmts.push_back(node->id);
+			current.insert(node->id);
+		}
+	}
+
+	// Statements that are gone take their names with them
+	std::unordered_set<ast::NodeId> known;
+	for (auto stmt : queries.get<analysis::ProgramStatements>({})) {
+		if (current.count(stmt) != 0) {
+			known.insert(stmt);
+		} else {
+			record(queries.get<analysis::StatementNames>(stmt));
+			queries.remove<analysis::StatementNames>(stmt);
+		}
+	}
+
+	// The names of a node never change, so they're only collected for new statements
+	analysis::DependencyPass deps;
+	for (auto& node : ast) {
+		if (node && known.count(node->id) == 0) {
+			deps.collect(*node);
+
+			analysis::StatementNames::Value names{ std::move(deps.declared), std::move(deps.required), std::move(deps.arguments) };
+			record(names);
+			queries.set<analysis::StatementNames>(node->id, std::move(names));
+			changes.added.push_back(node->id);
+		}
+	}
+
+	queries.set<analysis::ProgramStatements>({}, std::move(stmts));
+	return changes;
+}
+
 void AnalysisDriver::analyzeAst() {
 	if (!state.failed()) {
 		TIMER("ast_analysis");
 
+		updateProgramQueries();
+
 		RUN_PASS(analysis::VarDeclPass, state, decls);
-		RUN_PASS(analysis::VarRefPass, state, decls);
+
+		// Unsupported syntax is rejected while declaring, so the other passes never see it
+		if (state.failed()) {
+			return;
+		}
+
+		analysis::VarRefPass refs{ state, decls };
+		analyzeStatements(refs, statementsOf(ast));
 	}
 }
 
+void AnalysisDriver::analyzeStatements(analysis::VarRefPass& refs, const std::vector<ast::Ast*>& stmts) {
+	ast::visit(refs, stmts);
+
+	analysis::BasicTypingPass typing{ state, decls };
+	ast::visit(typing, stmts);
+	typing.finalize();
+
+	analysis::ConstFoldingPass folding{ decls };
+	ast::visit(folding, stmts);
+
+	analysis::ArrayPass arrays{ state, decls };
+	ast::visit(arrays, stmts);
+	arrays.finalize();
+
+	analysis::CallGraphPass calls{ decls };
+	ast::visit(calls, stmts);
+	calls.finalize();
+
+	analysis::EffectPass effects{ decls };
+	ast::visit(effects, stmts);
+	effects.finalize();
+}
+
+std::string AnalysisDriver::recompile(const std::string& old_source, const parser::TextEdit& edit) {
+	// Facts from a failed compile can't be trusted, so the program is analyzed from scratch
+	bool rebuild = state.failed();
+	state.reset();
+
+	// Uses of a name that is declared more than once depend on the order of the declarations, which the edit may have changed
+	auto declaredOnce = [](const analysis::GlobalDeclarations::Value& decls, const String& name) {
+		auto iter = decls.find(name);
+		return iter == decls.end() || iter->second.size() <= 1;
+	};
+	auto old_decls = queries.get<analysis::GlobalDeclarations>({});
+
+	parser::Stack replaced;
+	auto source = reparseInput(old_source, edit, replaced);
+	if (state.failed()) {
+		return source;
+	}
+
+	TIMER("incremental_compile");
+
+	// The replaced statements are forgotten while their names are still known
+	std::unordered_set<llvm::GlobalValue*> stale;
+	for (auto& node : replaced) {
+		forgetStatement(*node, stale);
+	}
+	replaced.clear();
+
+	auto changes = updateProgramQueries();
+
+	// Statements that use a name the edit rebinds are affected, and so are the statements that use their names in turn
+	auto& new_decls = queries.get<analysis::GlobalDeclarations>({});
+	auto& uses = queries.get<analysis::GlobalUses>({});
+
+	std::unordered_set<ast::NodeId> affected{ changes.added.begin(), changes.added.end() };
+	std::unordered_set<String> names;
+	std::vector<String> worklist;
+	auto rebind = [&](const String& name) {
+		if (names.insert(name).second) {
+			worklist.push_back(name);
+		}
+	};
+	std::for_each(changes.names.begin(), changes.names.end(), rebind);
+
+	while (!worklist.empty()) {
+		auto name = worklist.back();
+		worklist.pop_back();
+		rebuild |= !declaredOnce(old_decls, name) || !declaredOnce(new_decls, name);
+
+		if (auto iter = uses.find(name); iter != uses.end()) {
+			for (auto stmt : iter->second) {
+				if (affected.insert(stmt).second) {
+					auto& stmt_names = queries.get<analysis::StatementNames>(stmt);
+					std::for_each(stmt_names.declared.begin(), stmt_names.declared.end(), rebind);
+					std::for_each(stmt_names.arguments.begin(), stmt_names.arguments.end(), rebind);
+				}
+			}
+		}
+	}
+
+	std::vector<ast::Ast*> stmts;
+	if (rebuild) {
+		decls.forgetProgram();
+		analyzeAst();
+
+	} else {
+		// Affected statements that weren't edited are analyzed again in place, so they keep their nodes (and names)
+		std::unordered_set<ast::NodeId> added{ changes.added.begin(), changes.added.end() };
+		for (auto& node : ast) {
+			if (node && affected.count(node->id) != 0) {
+				if (added.count(node->id) == 0) {
+					forgetStatement(*node, stale);
+				}
+				stmts.push_back(node.get());
+			}
+		}
+
+		auto& global = decls.arena[analysis::GLOBAL_SYM_INDEX];
+		for (auto& name : names) {
+			global.erase(name);
+		}
+
+		analysis::VarDeclPass decl_pass{ state, decls };
+		ast::visit(decl_pass, stmts);
+
+		// Calls into the unaffected statements are resolved with the facts (and call graph) they already have
+		if (!state.failed()) {
+			analysis::VarRefPass refs{ state, decls };
+			analyzeStatements(refs, stmts);
+		}
+	}
+
+	if (state.failed()) {
+		return source;
+	}
+
+	// The module is generated from scratch if the old values can't be replaced, so symbols can't keep their storage from it
+	if (rebuild || !translation_unit || !eraseDefinitions(stale)) {
+		for (auto& table : decls.arena) {
+			table.forEachDefinition([](analysis::SymbolInfo& info) { info.storage = nullptr; info.slot_type = nullptr; });
+		}
+		translation_unit = nullptr;
+		translateAstToLlvm();
+		return source;
+	}
+
+	// Only the affected statements are translated again, into the module that still holds every other value
+	// Unaffected functions are also translated if they weren't before (ie. they only just became reachable)
+	for (auto& node : ast) {
+		auto* var = dynamic_cast<ast::VarAssign*>(node.get());
+		auto* fn = var ? util::viewAs<ast::Function>(var->expr) : nullptr;
+		if (fn && affected.count(node->id) == 0) {
+			auto name = decls.fn_name.at(fn->id);
+			if (name && !translation_unit->getFunction(name->get())) {
+				stmts.push_back(node.get());
+			}
+		}
+	}
+
+	gen::LlvmIrGenerator generator{ std::move(translation_unit), decls, state };
+	translateStatements(generator, stmts, true);
+	translation_unit = generator.finalize();
+
+	return source;
+}
+
+void AnalysisDriver::forgetStatement(ast::Ast& stmt, std::unordered_set<llvm::GlobalValue*>& stale) {
+	auto define = [&](const String& name) {
+		if (auto* value = translation_unit ? translation_unit->getNamedValue(name.get()) : nullptr) {
+			stale.insert(value);
+		}
+	};
+
+	// Globals are defined under the names that the statement declares, and functions under the names they're bound to
+	for (auto& name : queries.get<analysis::StatementNames>(stmt.id).declared) {
+		define(name);
+	}
+
+	// Scopes belong to a single statement, except for the global one
+	std::unordered_set<analysis::SymIndex> tables;
+	analysis::SubtreePass forget{ [&](ast::Ast& node) {
+		if (auto name = decls.fn_name.at(node.id)) {
+			define(*name);
+		}
+		if (auto table = decls.scope_of.at(node.id); table && *table != analysis::GLOBAL_SYM_INDEX) {
+			tables.insert(*table);
+		}
+
+		decls.forgetNode(node.id);
+	} };
+	stmt.accept(forget);
+
+	for (auto table : tables) {
+		decls.releaseTable(table);
+	}
+}
+
+bool AnalysisDriver::eraseDefinitions(const std::unordered_set<llvm::GlobalValue*>& stale) {
+	// Dropping the definitions first removes the references that the stale values make to each other
+	for (auto* value : stale) {
+		if (auto* fn = llvm::dyn_cast<llvm::Function>(value)) {
+			fn->deleteBody();
+		} else if (auto* var = llvm::dyn_cast<llvm::GlobalVariable>(value)) {
+			var->setInitializer(nullptr);
+		}
+	}
+
+	for (auto* value : stale) {
+		value->removeDeadConstantUsers();
+		if (!value->use_empty()) {
+			state.log(ID::info, "`{}` is still used after the edit, so the module is generated again", value->getName().str());
+			return false;
+		}
+	}
+
+	for (auto* value : stale) {
+		value->eraseFromParent();
+	}
+
+	for (auto iter = translation_unit->global_begin(); iter != translation_unit->global_end();) {
+		auto& global = *iter++;
+		global.removeDeadConstantUsers();
+
+		if (global.hasPrivateLinkage() && global.use_empty()) {
+			global.eraseFromParent();
+		}
+	}
+
+	return true;
+}
+
 void AnalysisDriver::translateAstToLlvm() {
 	if (!state.failed()) {
 		TIMER("llvm_ir_translation");
 
-		gen::LlvmIrGenerator visitor{ std::move(translation_unit), decls.arena, state };
-		ast::visit(visitor, ast);
-		translation_unit = std::move(visitor.finalize());
+		gen::LlvmIrGenerator generator{ std::move(translation_unit), decls, state };
+		translateStatements(generator, statementsOf(ast), true);
+		translation_unit = generator.finalize();
+	}
+}
+
+void AnalysisDriver::translateStatements(gen::LlvmIrGenerator& generator, const std::vector<ast::Ast*>& stmts, bool prune) {
+	// Every top-level function is declared upfront, so calls can refer to functions that are defined later (or recursively)
+	auto definedFunction = [&](ast::Ast* node) -> ast::Function* {
+		auto* var = dynamic_cast<ast::VarAssign*>(node);
+		auto* fn = var ? util::viewAs<ast::Function>(var->expr) : nullptr;
+		return fn && decls.fn_name.at(fn->id) ? fn : nullptr;
+	};
+
+	// Only the functions reachable from the program's entry points are lowered at all
+	// NOTE: The entry points are found in the whole ast, as `stmts` may only be the part of it that changed (see `recompile`)
+	auto& calls = decls.calls;
+	std::unordered_set<ast::NodeId> reachable;
+	if (prune) {
+		std::vector<ast::NodeId> roots;
+		for (auto* node : statementsOf(ast)) {
+			if (auto* fn = definedFunction(node)) {
+				auto name = *decls.fn_name.at(fn->id);
+				if (name == string::names::main || name == string::names::jitfunc || isExported(*dynamic_cast<ast::VarAssign*>(node))) {
+					roots.push_back(fn->id);
+				}
+			}
+		}
+
+		reachable = calls.reachableFrom(roots);
+	}
+	size_t skipped = 0;
+
+	std::unordered_map<ast::NodeId, ast::Ast*> definitions;
+	for (auto* node : stmts) {
+		if (auto* fn = definedFunction(node)) {
+			if (prune && calls.componentOf(fn->id) && reachable.count(fn->id) == 0) {
+				++skipped;
+				continue;
+			}
+
+			generator.declareFunction(*fn);
+			definitions[fn->id] = node;
+		}
 	}
+
+	if (skipped != 0) {
+		state.log(ID::info, "Skipped lowering {} unreachable function(s)", skipped);
+	}
+
+	// Other statements keep their source order
+	for (auto* node : stmts) {
+		if (!definedFunction(node)) {
+			node->accept(generator);
+		}
+	}
+
+	// Then the function bodies are generated callees first (see `CallGraph`)
+	// TODO: The components within a wave are independent, so they could be generated in parallel (needs a module per thread)
+	for (auto& wave : calls.waves()) {
+		for (auto component : wave) {
+			for (auto fn : calls.components()[component]) {
+				if (auto iter = definitions.find(fn); iter != definitions.end()) {
+					iter->second->accept(generator);
+					definitions.erase(iter);
+				}
+			}
+		}
+	}
+
+	// Functions the call graph doesn't know about are generated in source order
+	for (auto* node : stmts) {
+		if (auto* fn = definedFunction(node); fn && definitions.count(fn->id)) {
+			node->accept(generator);
+		}
+	}
+}
+
+bool AnalysisDriver::isExported(const ast::VarAssign& def) {
+	// Public definitions are only visible to other code when we aren't linking the final executable ourselves
+	return def.vis == +ast::VisibilityType::PUBLIC && !state.produceExe();
 }
 
 void AnalysisDriver::optimizeLlvm() {
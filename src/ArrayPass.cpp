@@ -0,0 +1,553 @@
+#include "analysis/ArrayPass.h"
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <utility>
+
+namespace spero::analysis {
+	using namespace compiler;
+
+	ArrayPass::ArrayPass(CompilationState& state, AnalysisState& dict) : state{ state }, dictionary{ dict } {}
+
+	static bool isUnchecked(ast::Statement& stmt) {
+		return std::any_of(stmt.annots.begin(), stmt.annots.end(), [](auto& annot) { return annot->name->name == "unchecked"; });
+	}
+
+	// Arrays of constants are emitted as constant globals, so they're never allocated
+	static bool isConstant(const AnalysisState& dictionary, ast::Array& array) {
+		auto folded = [&](auto& elem) { return dictionary.const_of.at(elem->id).has_value(); };
+		return std::all_of(array.elems.begin(), array.elems.end(), folded);
+	}
+
+	static bool isArray(const AnalysisState& dictionary, ast::ValExpr& expr) {
+		auto type = dictionary.type_of.at(expr.id).value_or(nullptr);
+		return type && type->kind() == +TypeKind::ARRAY;
+	}
+
+	// The value of the expression if it's a constant `Int`
+	static opt_t<int64_t> constantInt(const AnalysisState& dictionary, ast::ValExpr& expr) {
+		auto value = dictionary.const_of.at(expr.id);
+		auto* val = value ? std::get_if<int64_t>(&*value) : nullptr;
+		return val ? std::optional{ *val } : std::nullopt;
+	}
+
+	void ArrayPass::finalize() {
+		// Arguments are borrowed unless they're passed on to one that isn't, which may only be known once its function is visited
+		std::unordered_map<ast::NodeId, bool> borrows;
+		for (auto&[binding, param] : params) {
+			borrows[param.arg] = !param.uses.escapes && !param.uses.returned;
+		}
+
+		auto borrowed = [&](ast::NodeId arg) {
+			auto iter = borrows.find(arg);
+			return iter != borrows.end() ? iter->second : dictionary.borrowed_arg.at(arg).value_or(false);
+		};
+		auto contained = [&](const Uses& uses) {
+			return !uses.escapes && std::all_of(uses.lent.begin(), uses.lent.end(), borrowed);
+		};
+
+		for (auto changed = true; changed; ) {
+			changed = false;
+			for (auto&[binding, param] : params) {
+				if (borrows[param.arg] && !contained(param.uses)) {
+					borrows[param.arg] = false;
+					changed = true;
+				}
+			}
+		}
+
+		// Likewise a function only returns arrays it created if the functions it returns the results of do
+		std::unordered_map<ast::NodeId, bool> fresh;
+		for (auto fn : visited_fns) {
+			fresh[fn] = returns_other.count(fn) == 0;
+		}
+
+		auto returnsFresh = [&](ast::NodeId fn) {
+			auto iter = fresh.find(fn);
+			return iter != fresh.end() ? iter->second : dictionary.fresh_result.at(fn).value_or(false);
+		};
+		auto isFresh = [&](const Source& source) {
+			return contained(source.uses) && (source.callee ? returnsFresh(*source.callee) : !source.constant);
+		};
+
+		std::vector<const Source*> all_sources;
+		for (auto&[binding, array] : arrays) {
+			all_sources.push_back(&array.source);
+		}
+		for (auto&[node, source] : sources) {
+			all_sources.push_back(&source);
+		}
+
+		for (auto changed = true; changed; ) {
+			changed = false;
+			for (auto* source : all_sources) {
+				if (source->uses.returned && source->fn && fresh[*source->fn] && !isFresh(*source)) {
+					fresh[*source->fn] = false;
+					changed = true;
+				}
+			}
+		}
+
+		for (auto&[arg, is_borrowed] : borrows) {
+			dictionary.borrowed_arg[arg] = is_borrowed;
+		}
+		for (auto&[fn, is_fresh] : fresh) {
+			dictionary.fresh_result[fn] = is_fresh;
+		}
+
+		// Arrays that stay within the call are stack allocated, and the arrays returned to a call are freed with the caller's
+		for (auto* source : all_sources) {
+			if (!source->fn || source->uses.returned || !contained(source->uses)) {
+				continue;
+			}
+
+			if (!source->callee) {
+				dictionary.local_array[source->node] = true;
+			} else if (returnsFresh(*source->callee)) {
+				dictionary.owned_result[source->node] = true;
+			}
+		}
+
+		// Counters are only known to be monotonic once all of their assignments have been seen
+		for (auto& access : accesses) {
+			auto iter = counters.find(access.counter);
+			if (iter == counters.end() || !iter->second.monotonic) {
+				continue;
+			}
+
+			auto assigns = [&](ast::NodeId loop) { return loop_writes[loop].count(access.counter) != 0; };
+			if (std::none_of(access.loops.begin(), access.loops.end(), assigns)) {
+				dictionary.in_bounds[access.index] = true;
+			}
+		}
+
+		arrays.clear();
+		params.clear();
+		counters.clear();
+		accesses.clear();
+		sources.clear();
+		visited_fns.clear();
+		returns_other.clear();
+		loop_writes.clear();
+	}
+
+
+	// Helpers
+	opt_t<ArrayPass::Binding> ArrayPass::bindingOf(ast::Variable& var) {
+		auto def_table = dictionary.def_table.at(var.id);
+		auto& part = *var.name->elems.back();
+		auto ssa_index = dictionary.ssa_index.at(part.id);
+
+		if (!def_table || !ssa_index) {
+			return std::nullopt;
+		}
+
+		return Binding{ *def_table, part.name, *ssa_index };
+	}
+
+	opt_t<ast::NodeId> ArrayPass::currentFunction() const {
+		return functions.empty() ? std::nullopt : std::optional{ functions.back() };
+	}
+
+	ast::Function* ArrayPass::calleeOf(ast::FnCall& call) {
+		auto* var = dynamic_cast<ast::Variable*>(call.callee.get());
+		auto def_table = var ? dictionary.def_table.at(var->id) : std::nullopt;
+		if (!def_table) {
+			return nullptr;
+		}
+
+		// NOTE: Definitions are dropped once their statement is freed (ie. when streaming), so those calls aren't tracked
+		auto& part = *var->name->elems.back();
+		auto ssa_index = dictionary.ssa_index.at(part.id);
+		auto sym = dictionary.arena[*def_table].get(part.name, nullptr, ssa_index);
+		auto* info = sym ? std::get_if<ref_t<SymbolInfo>>(&*sym) : nullptr;
+		return info && !info->get().is_mut ? dynamic_cast<ast::Function*>(info->get().definition) : nullptr;
+	}
+
+	ArrayPass::Uses* ArrayPass::visitUse(ast::ValExpr& expr) {
+		auto fn = currentFunction();
+
+		if (auto* var = dynamic_cast<ast::Variable*>(&expr)) {
+			// Uses from a nested function may happen after the enclosing call has returned
+			if (auto binding = bindingOf(*var)) {
+				if (auto array = arrays.find(*binding); array != arrays.end()) {
+					array->second.source.uses.escapes |= array->second.source.fn != fn;
+					return &array->second.source.uses;
+				}
+				if (auto param = params.find(*binding); param != params.end()) {
+					param->second.uses.escapes |= param->second.fn != fn;
+					return &param->second.uses;
+				}
+			}
+
+		} else if (auto* literal = dynamic_cast<ast::Array*>(&expr); literal && fn) {
+			AstVisitor::visitArray(*literal);
+
+			auto& source = sources[literal->id] = Source{ literal->id, std::nullopt, fn, isConstant(dictionary, *literal) };
+			return &source.uses;
+
+		} else if (auto* call = dynamic_cast<ast::FnCall*>(&expr); call && fn) {
+			call->accept(*this);
+
+			auto* callee = calleeOf(*call);
+			if (!callee || !isArray(dictionary, *call)) {
+				return nullptr;
+			}
+
+			auto& source = sources[call->id] = Source{ call->id, callee->id, fn };
+			return &source.uses;
+		}
+
+		expr.accept(*this);
+		return nullptr;
+	}
+
+	void ArrayPass::visitLent(ast::ValExpr& expr, ast::NodeId arg) {
+		if (auto* uses = visitUse(expr)) {
+			uses->lent.push_back(arg);
+		}
+	}
+
+	void ArrayPass::visitReturned(ast::ValExpr& expr) {
+		// A block returns its last value
+		if (auto* block = dynamic_cast<ast::Block*>(&expr)) {
+			auto outer_result = std::exchange(result_block, block->id);
+			block->accept(*this);
+			result_block = outer_result;
+			return;
+		}
+
+		if (auto* uses = visitUse(expr)) {
+			uses->returned = true;
+		} else if (auto fn = currentFunction()) {
+			returns_other.insert(*fn);
+		}
+	}
+
+	void ArrayPass::addGuards(ast::ValExpr& test) {
+		auto* bin = dynamic_cast<ast::BinOpCall*>(&test);
+		if (!bin) {
+			return;
+		}
+
+		// Every conjunct holds when the whole test does
+		if (bin->op == "&&") {
+			addGuards(*bin->lhs);
+			addGuards(*bin->rhs);
+			return;
+		}
+
+		// Normalize the comparison to `counter < bound`
+		auto* lhs = bin->lhs.get();
+		auto* rhs = bin->rhs.get();
+		auto op = bin->op;
+		if (op == ">" || op == ">=") {
+			std::swap(lhs, rhs);
+			op = (op == ">") ? "<" : "<=";
+		}
+
+		auto* counter = dynamic_cast<ast::Variable*>(lhs);
+		auto bound = constantInt(dictionary, *rhs);
+		auto binding = counter ? bindingOf(*counter) : std::nullopt;
+		if (!binding || !bound || (op != "<" && op != "<=")) {
+			return;
+		}
+
+		// `i <= n` is `i < n + 1`, which can't overflow as it's only compared against array lengths
+		if (op == "<=") {
+			if (*bound == std::numeric_limits<int64_t>::max()) {
+				return;
+			}
+			++*bound;
+		}
+
+		guards.push_back(Guard{ *binding, *bound, loops.size() - 1 });
+	}
+
+	void ArrayPass::assigned(const Binding& binding, bool increment) {
+		for (auto loop : loops) {
+			loop_writes[loop].insert(binding);
+		}
+		for (auto& guard : guards) {
+			if (guard.counter == binding) {
+				guard.valid = false;
+			}
+		}
+
+		// An assignment from another function may happen at any point in the counting loop (ie. through a call)
+		if (auto iter = counters.find(binding); iter != counters.end()) {
+			iter->second.monotonic &= increment && currentFunction() == iter->second.fn;
+		}
+	}
+
+	void ArrayPass::checkIndex(ast::ValExpr& index, opt_t<size_t> length) {
+		if (unchecked != 0) {
+			dictionary.in_bounds[index.id] = true;
+			return;
+		}
+
+		if (!length) {
+			return;
+		}
+
+		if (auto value = constantInt(dictionary, index)) {
+			if (*value >= 0 && static_cast<size_t>(*value) < *length) {
+				dictionary.in_bounds[index.id] = true;
+			} else {
+				state.log(ID::err, "Index {} is out of bounds for an array of length {} <at {}>", *value, *length, index.loc);
+			}
+			return;
+		}
+
+		auto* var = dynamic_cast<ast::Variable*>(&index);
+		auto binding = var ? bindingOf(*var) : std::nullopt;
+		if (!binding) {
+			return;
+		}
+
+		// The innermost guard is the one established most recently, so it's the most likely to still hold
+		for (auto guard = guards.rbegin(); guard != guards.rend(); ++guard) {
+			if (guard->counter == *binding && guard->valid && static_cast<uint64_t>(guard->bound) <= *length) {
+				accesses.push_back(CountedAccess{ index.id, *binding, { loops.begin() + guard->depth + 1, loops.end() } });
+				return;
+			}
+		}
+	}
+
+	void ArrayPass::visitBody(ast::Loop& loop, ast::ValExpr* test) {
+		loops.push_back(loop.id);
+
+		auto num_guards = guards.size();
+		if (test) {
+			addGuards(*test);
+		}
+
+		loop.body->accept(*this);
+
+		guards.resize(num_guards);
+		loops.pop_back();
+	}
+
+	void ArrayPass::visitAnnotated(ast::Statement& stmt, bool returned) {
+		auto is_unchecked = isUnchecked(stmt);
+
+		unchecked += is_unchecked;
+		if (auto* value = dynamic_cast<ast::ValExpr*>(&stmt); value && returned) {
+			visitReturned(*value);
+		} else {
+			stmt.accept(*this);
+		}
+		unchecked -= is_unchecked;
+	}
+
+
+	// Atoms
+	void ArrayPass::visitBlock(ast::Block& b) {
+		auto parent_scope = current;
+		current = dictionary.scope_of.at(b.id).value_or(current);
+
+		auto returned = result_block == b.id;
+		for (auto& stmt : b.elems) {
+			visitAnnotated(*stmt, returned && &stmt == &b.elems.back());
+		}
+
+		// The function returns unit if the block doesn't end in a value
+		auto fn = currentFunction();
+		if (returned && fn && (b.elems.empty() || !dynamic_cast<ast::ValExpr*>(b.elems.back().get()))) {
+			returns_other.insert(*fn);
+		}
+
+		current = parent_scope;
+	}
+
+	void ArrayPass::visitFunction(ast::Function& f) {
+		// Loop tests don't hold when a nested function is called, so the function starts with a clean slate
+		auto outer_loops = std::exchange(loops, {});
+		auto outer_guards = std::exchange(guards, {});
+		auto outer_result = std::exchange(result_block, f.body->id);
+		functions.push_back(f.id);
+		visited_fns.push_back(f.id);
+
+		// Arguments are bound in the enclosing scope (see `VarDeclPass`)
+		for (auto& arg : f.args) {
+			if (auto ssa_index = dictionary.ssa_index.at(arg->id)) {
+				params.insert_or_assign(Binding{ current, arg->name->name, *ssa_index }, Param{ arg->id, f.id });
+			}
+			arg->accept(*this);
+		}
+		f.body->accept(*this);
+
+		functions.pop_back();
+		result_block = outer_result;
+		guards = std::move(outer_guards);
+		loops = std::move(outer_loops);
+	}
+
+
+	// Names
+	void ArrayPass::visitVariable(ast::Variable& v) {
+		AstVisitor::visitVariable(v);
+
+		// Any use of an array that isn't tracked (see `visitUse`) may outlive the call
+		if (auto binding = bindingOf(v)) {
+			if (auto iter = arrays.find(*binding); iter != arrays.end()) {
+				iter->second.source.uses.escapes = true;
+			}
+			if (auto iter = params.find(*binding); iter != params.end()) {
+				iter->second.uses.escapes = true;
+			}
+		}
+	}
+
+
+	// Control
+	void ArrayPass::visitLoop(ast::Loop& l) {
+		visitBody(l, nullptr);
+	}
+
+	void ArrayPass::visitWhile(ast::While& w) {
+		w.test->accept(*this);
+		visitBody(w, w.test.get());
+	}
+
+	void ArrayPass::visitJump(ast::Jump& j) {
+		if (j.type != +ast::KeywordType::RET) {
+			AstVisitor::visitJump(j);
+
+		} else if (j.expr) {
+			visitReturned(*j.expr);
+
+		} else if (auto fn = currentFunction()) {
+			returns_other.insert(*fn);
+		}
+	}
+
+	void ArrayPass::visitFor(ast::For& f) {
+		// Iterating reads the array like indexing does, so it doesn't make the array escape
+		visitUse(*f.generator);
+
+		auto parent_scope = current;
+		current = dictionary.scope_of.at(f.id).value_or(current);
+
+		visitBody(f, nullptr);
+
+		current = parent_scope;
+	}
+
+
+	// Statements
+	void ArrayPass::visitVarAssign(ast::VarAssign& v) {
+		// Top level statements aren't in a block, so their annotations aren't handled by `visitAnnotated`
+		auto is_unchecked = functions.empty() && isUnchecked(v);
+
+		unchecked += is_unchecked;
+		AstVisitor::visitVarAssign(v);
+		unchecked -= is_unchecked;
+
+		// TODO: Destructuring assignments don't introduce arrays or counters yet
+		auto* name = dynamic_cast<ast::AssignName*>(v.name.get());
+		auto ssa_index = name ? dictionary.ssa_index.at(name->id) : std::nullopt;
+		if (!ssa_index) {
+			return;
+		}
+
+		auto binding = Binding{ current, name->var->name, *ssa_index };
+		if (auto* array = dynamic_cast<ast::Array*>(v.expr.get()); array && !name->is_mut) {
+			arrays.insert_or_assign(binding, ArrayBinding{ Source{ array->id, std::nullopt, currentFunction(), isConstant(dictionary, *array) }, array->elems.size() });
+
+		} else if (auto* call = dynamic_cast<ast::FnCall*>(v.expr.get()); call && !name->is_mut && isArray(dictionary, *call)) {
+			if (auto* callee = calleeOf(*call)) {
+				arrays.insert_or_assign(binding, ArrayBinding{ Source{ call->id, callee->id, currentFunction() } });
+			}
+
+		} else if (name->is_mut && !functions.empty() && dictionary.arena[current].context() == +ScopingContext::SCOPE) {
+			auto init = constantInt(dictionary, *v.expr);
+			counters.insert_or_assign(binding, Counter{ functions.back(), init && *init >= 0 });
+		}
+	}
+
+
+	// Expressions
+	void ArrayPass::visitInAssign(ast::InAssign& in) {
+		auto parent_scope = current;
+		current = dictionary.scope_of.at(in.id).value_or(current);
+
+		AstVisitor::visitInAssign(in);
+
+		current = parent_scope;
+	}
+
+	void ArrayPass::visitBinOpCall(ast::BinOpCall& b) {
+		AstVisitor::visitBinOpCall(b);
+
+		auto* lhs = dynamic_cast<ast::Variable*>(b.lhs.get());
+		auto binding = lhs ? bindingOf(*lhs) : std::nullopt;
+		if (b.op != string::names::assign || !binding) {
+			return;
+		}
+
+		// Recognize `i = i + n` and `i = n + i`
+		auto* rhs = dynamic_cast<ast::BinOpCall*>(b.rhs.get());
+		auto isCounter = [&](ast::ValExpr& expr) {
+			auto* var = dynamic_cast<ast::Variable*>(&expr);
+			return var && bindingOf(*var) == binding;
+		};
+		auto isStep = [&](ast::ValExpr& expr) {
+			auto step = constantInt(dictionary, expr);
+			return step && *step >= 0;
+		};
+
+		auto increment = rhs && rhs->op == "+"
+			&& ((isCounter(*rhs->lhs) && isStep(*rhs->rhs)) || (isStep(*rhs->lhs) && isCounter(*rhs->rhs)));
+		assigned(*binding, increment);
+	}
+
+	void ArrayPass::visitIndex(ast::Index& i) {
+		auto& indexed = *i.elems.front();
+
+		// Typing leaves `a.b.c` chains that aren't indexing untyped, so there are no bounds to check
+		auto type = dictionary.type_of.at(indexed.id).value_or(nullptr);
+		if (!type || type->kind() != +TypeKind::ARRAY) {
+			AstVisitor::visitIndex(i);
+			return;
+		}
+
+		// The length of the indexed array is only known for literals and names bound to them
+		opt_t<size_t> length;
+		auto* var = dynamic_cast<ast::Variable*>(&indexed);
+		auto binding = var ? bindingOf(*var) : std::nullopt;
+
+		if (auto array = binding ? arrays.find(*binding) : arrays.end(); array != arrays.end()) {
+			length = array->second.length;
+		} else if (auto* literal = dynamic_cast<ast::Array*>(&indexed)) {
+			length = literal->elems.size();
+		}
+		visitUse(indexed);
+
+		// Only the first index is into an array of known length
+		for (auto iter = std::next(i.elems.begin()); iter != i.elems.end(); ++iter) {
+			(*iter)->accept(*this);
+			checkIndex(**iter, std::exchange(length, std::nullopt));
+		}
+	}
+
+	void ArrayPass::visitFnCall(ast::FnCall& f) {
+		f.callee->accept(*this);
+		if (!f.arguments) {
+			return;
+		}
+
+		// Arrays passed to an argument that the callee only borrows don't outlive the call (see `finalize`)
+		auto* callee = calleeOf(f);
+		auto& args = f.arguments->elems;
+		for (size_t i = 0; i != args.size(); ++i) {
+			if (callee && i < callee->args.size()) {
+				visitLent(*args[i], callee->args[i]->id);
+			} else {
+				args[i]->accept(*this);
+			}
+		}
+	}
+
+}
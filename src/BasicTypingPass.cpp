@@ -1,71 +1,433 @@
 #include "analysis/BasicTypingPass.h"
 #include "util/parser.h"
 
+#include <algorithm>
+#include <iterator>
+#include <sstream>
+
 namespace spero::analysis {
 	using namespace compiler;
 
-	BasicTypingPass::BasicTypingPass(CompilationState& state, AnalysisState& dict) : dictionary{ dict }, state{ state } {
-		//current = dictionary.arena.get();
+	BasicTypingPass::BasicTypingPass(CompilationState& state, AnalysisState& dict) : dictionary{ dict }, state{ state } {}
+
+	static std::string typeName(const Type* type) {
+		if (!type) {
+			return "_";
+		}
+
+		std::ostringstream out;
+		static_cast<std::ostream&>(out) << *type;
+		return out.str();
+	}
+
+
+	// Type variable accessors
+	TypeVar BasicTypingPass::typeOf(ast::ValExpr& expr) {
+		auto& var = exprs[expr.id];
+		if (!var.has_value()) {
+			var = unifier.fresh();
+			typed_exprs.push_back(expr.id);
+		}
+
+		return *var;
+	}
+	TypeVar BasicTypingPass::typeOf(SymIndex table, const String& name, opt_t<size_t> ssa_index) {
+		// Symbols that failed to be declared/resolved still need a variable to keep the analysis going
+		if (!ssa_index.has_value()) {
+			return unifier.fresh();
+		}
+
+		auto[iter, inserted] = symbols.try_emplace(SymbolKey{ table, name, *ssa_index }, 0);
+		if (inserted) {
+			// Symbols that were typed by an earlier run (ie. for an earlier batch of statements) keep their type
+			auto sym = dictionary.arena[table].get(name, nullptr, ssa_index);
+			auto* info = sym ? std::get_if<ref_t<SymbolInfo>>(&*sym) : nullptr;
+			iter->second = unifier.known(info ? info->get().type : nullptr);
+		}
+
+		return iter->second;
+	}
+
+
+	// Constraint helpers
+	void BasicTypingPass::unify(TypeVar lhs, TypeVar rhs, const Location& loc) {
+		if (!unifier.unify(lhs, rhs)) {
+			auto[expected, found] = unifier.conflict();
+			state.log(ID::err, "Type: Mismatched types `{}` and `{}` <at {}>", typeName(expected), typeName(found), loc);
+		}
+	}
+	void BasicTypingPass::bind(TypeVar var, const Type* type, const Location& loc) {
+		// Missing core types have already been reported
+		if (type && !unifier.bind(var, type)) {
+			auto[found, expected] = unifier.conflict();
+			state.log(ID::err, "Type: Expected `{}` but found `{}` <at {}>", typeName(expected), typeName(found), loc);
+		}
+	}
+	void BasicTypingPass::bindAnnotation(TypeVar var, ast::Type& annot, const Location& loc) {
+		// TODO: The actual handling of type annotations is a lot more subtle than I've used here
+			// But I need a better way of converting an 'ast::Type' into a 'analysis::Type'
+		if (auto* type = dynamic_cast<ast::SourceType*>(&annot)) {
+			auto* named = dictionary.typeNamed(type->name->elems.back()->name);
+			if (!named) {
+				state.log(ID::err, "Installation does not define a `<>` type <at {}>", *type->name->elems.back(), loc);
+			}
+
+			bind(var, named, loc);
+		}
+	}
+
+	void BasicTypingPass::bindPattern(ast::AssignPattern& pattern, TypeVar var, const Location& loc) {
+		if (auto* name = dynamic_cast<ast::AssignName*>(&pattern)) {
+			unify(typeOf(current, name->var->name, dictionary.ssa_index.at(name->id)), var, loc);
+
+		} else if (auto* tuple = dynamic_cast<ast::AssignTuple*>(&pattern)) {
+			// `(a)` is just a parenthesized name
+			if (tuple->elems.size() == 1) {
+				return bindPattern(*tuple->elems.front(), var, loc);
+			}
+
+			std::vector<TypeVar> elems;
+			for (size_t i = 0; i != tuple->elems.size(); ++i) {
+				elems.push_back(unifier.fresh());
+			}
+			unify(unifier.tuple(elems), var, loc);
+
+			for (size_t i = 0; i != elems.size(); ++i) {
+				bindPattern(*tuple->elems[i], elems[i], loc);
+			}
+		}
+
+		// NOTE: `_` matches anything
+	}
+
+	void BasicTypingPass::finalize() {
+		// Resolving a function type has to build it, so only do that once per class
+		std::unordered_map<TypeVar, const Type*> resolved;
+		auto resolve = [&](TypeVar var) {
+			auto root = unifier.find(var);
+			if (auto iter = resolved.find(root); iter != resolved.end()) {
+				return iter->second;
+			}
+
+			return resolved[root] = unifier.resolve(root, dictionary.types);
+		};
+
+		for (auto id : typed_exprs) {
+			dictionary.type_of[id] = resolve(*exprs.at(id));
+		}
+
+		for (auto&[key, var] : symbols) {
+			opt_t<size_t> ssa_index = key.ssa_index;
+			if (auto sym = dictionary.arena[key.table].get(key.name, nullptr, ssa_index)) {
+				if (auto* info = std::get_if<ref_t<SymbolInfo>>(&*sym)) {
+					info->get().type = resolve(var);
+				}
+			}
+		}
+
+		// The ast may be released after this point (ie. when streaming statements)
+		// Symbols are kept as later statements can still refer to them
+		exprs.clear();
+		typed_exprs.clear();
 	}
 
 
 	// Atoms
 	void BasicTypingPass::visitInt(ast::Int& i) {
-		if (dictionary.type_list.count("Int") == 0) {
+		if (!dictionary.core.Int) {
 			state.log(ID::err, "Installation does not define an `Int` type <at {}>", i.loc);
 		}
 
-		i.type = dictionary.type_list["Int"];
+		bind(typeOf(i), dictionary.core.Int, i.loc);
 	}
 
 	void BasicTypingPass::visitString(ast::String& i) {
-		if (dictionary.type_list.count("String") == 0) {
+		if (!dictionary.core.String) {
 			state.log(ID::err, "Installation does not define a `String` type <at {}>", i.loc);
 		}
 
-		i.type = dictionary.type_list["String"];
+		bind(typeOf(i), dictionary.core.String, i.loc);
 	}
 
 	void BasicTypingPass::visitBool(ast::Bool& i) {
-		if (dictionary.type_list.count("Bool") == 0) {
+		if (!dictionary.core.Bool) {
 			state.log(ID::err, "Installation does not define a `Bool` type <at {}>", i.loc);
 		}
 
-		i.type = dictionary.type_list["Bool"];
+		bind(typeOf(i), dictionary.core.Bool, i.loc);
 	}
 
+	void BasicTypingPass::visitFloat(ast::Float& f) {
+		if (!dictionary.core.Float) {
+			state.log(ID::err, "Installation does not define a `Float` type <at {}>", f.loc);
+		}
+
+		bind(typeOf(f), dictionary.core.Float, f.loc);
+	}
+
+	void BasicTypingPass::visitChar(ast::Char& c) {
+		if (!dictionary.core.Char) {
+			state.log(ID::err, "Installation does not define a `Char` type <at {}>", c.loc);
+		}
+
+		bind(typeOf(c), dictionary.core.Char, c.loc);
+	}
+
+	void BasicTypingPass::visitByte(ast::Byte& b) {
+		if (!dictionary.core.Byte) {
+			state.log(ID::err, "Installation does not define a `Byte` type <at {}>", b.loc);
+		}
+
+		bind(typeOf(b), dictionary.core.Byte, b.loc);
+	}
+
+	void BasicTypingPass::visitTuple(ast::Tuple& t) {
+		AstVisitor::visitTuple(t);
+
+		// A single parenthesized expression is just that expression (ie. `(a + b) * c`)
+		if (t.elems.size() == 1) {
+			unify(typeOf(t), typeOf(*t.elems.front()), t.loc);
+			return;
+		}
+
+		std::vector<TypeVar> elems;
+		for (auto& val : t.elems) {
+			elems.push_back(typeOf(*val));
+		}
+
+		unify(typeOf(t), unifier.tuple(std::move(elems)), t.loc);
+	}
+
+	void BasicTypingPass::visitArray(ast::Array& a) {
+		AstVisitor::visitArray(a);
+
+		// Every element has the same type (the element type of an empty array is left to its uses)
+		auto elem = unifier.fresh();
+		for (auto& val : a.elems) {
+			unify(elem, typeOf(*val), val->loc);
+		}
+
+		unify(typeOf(a), unifier.array(elem), a.loc);
+	}
+
+	void BasicTypingPass::visitBlock(ast::Block& b) {
+		auto parent_scope = current;
+		current = *dictionary.scope_of.at(b.id);
+
+		AstVisitor::visitBlock(b);
+
+		current = parent_scope;
+
+		// The value of a block is the value of its last expression
+		if (!b.elems.empty()) {
+			if (auto* last = dynamic_cast<ast::ValExpr*>(b.elems.back().get())) {
+				unify(typeOf(b), typeOf(*last), last->loc);
+			}
+		}
+	}
+
+	void BasicTypingPass::visitFunction(ast::Function& f) {
+		auto ret = unifier.fresh();
+
+		returns.push_back(ret);
+		AstVisitor::visitFunction(f);
+		returns.pop_back();
+
+		unify(ret, typeOf(*f.body), f.body->loc);
+
+		// Arguments are declared in the scope enclosing the function (see `VarDeclPass`)
+		std::vector<TypeVar> args;
+		for (auto& arg : f.args) {
+			args.push_back(typeOf(current, arg->name->name, dictionary.ssa_index.at(arg->id)));
+		}
+
+		unify(typeOf(f), unifier.function(std::move(args), ret), f.loc);
+	}
+
+
 	// Decorations
 	void BasicTypingPass::visitTypeAnnotation(ast::TypeAnnotation& t) {
 		AstVisitor::visitTypeAnnotation(t);
 
-		// TODO: The actual handling of type annotations is a lot more subtle than I've used here
-			// But I need a better way of converting an 'ast::Type' into a 'analysis::Type'
-		if (util::isType<ast::SourceType>(t.typ)) {
-			auto* type = util::viewAs<ast::SourceType>(t.typ);
+		// TODO: This should override the expression's type (if compatible), influence the expression's type (if unsettled), or throw an error (if incompatible)
+		auto type = typeOf(t);
+		unify(type, typeOf(*t.expression), t.loc);
+		bindAnnotation(type, *t.typ, t.loc);
+	}
 
-			if (dictionary.type_list.count(type->name->elems.back()->name) == 0) {
-				state.log(ID::err, "Installation does not define a `<>` type <at {}>", *type->name->elems.back(), t.loc);
-			}
+	void BasicTypingPass::visitArgument(ast::Argument& arg) {
+		AstVisitor::visitArgument(arg);
 
-			// TODO: This should override the expression's type (if compatible), influence the expression's type (if unsettled), or throw an error (if incompatible)
-			t.type = dictionary.type_list[type->name->elems.back()->name];
+		if (arg.typ) {
+			bindAnnotation(typeOf(current, arg.name->name, dictionary.ssa_index.at(arg.id)), *arg.typ, arg.loc);
+		}
+	}
 
-		} else {
-			t.type = t.expression->type;
+
+	// Control
+	void BasicTypingPass::visitLoop(ast::Loop& l) {
+		AstVisitor::visitLoop(l);
+
+		// Loops don't produce a value, so they have the unit type (ie. the empty tuple)
+		bind(typeOf(l), dictionary.types.tuple({}), l.loc);
+	}
+
+	void BasicTypingPass::visitFor(ast::For& f) {
+		f.generator->accept(*this);
+
+		auto parent_scope = current;
+		current = *dictionary.scope_of.at(f.id);
+
+		// Only arrays can be iterated over for now, binding each element in turn
+		auto elem = unifier.fresh();
+		if (auto* var = dynamic_cast<ast::VarPattern*>(f.pattern.get())) {
+			elem = typeOf(current, var->name->elems.back()->name, dictionary.ssa_index.at(var->id));
+		}
+		unify(typeOf(*f.generator), unifier.array(elem), f.generator->loc);
+
+		f.body->accept(*this);
+		current = parent_scope;
+
+		bind(typeOf(f), dictionary.types.tuple({}), f.loc);
+	}
+
+	void BasicTypingPass::visitWhile(ast::While& w) {
+		AstVisitor::visitWhile(w);
+
+		bind(typeOf(*w.test), dictionary.core.Bool, w.test->loc);
+		bind(typeOf(w), dictionary.types.tuple({}), w.loc);
+	}
+
+	void BasicTypingPass::visitIfBranch(ast::IfBranch& b) {
+		AstVisitor::visitIfBranch(b);
+
+		bind(typeOf(*b.test), dictionary.core.Bool, b.test->loc);
+	}
+
+	void BasicTypingPass::visitIfElse(ast::IfElse& e) {
+		AstVisitor::visitIfElse(e);
+
+		// Branches only join into a value if every path produces one
+		if (e.else_) {
+			auto type = typeOf(e);
+			for (auto& branch : e.elems) {
+				unify(type, typeOf(*branch->body), branch->body->loc);
+			}
+
+			unify(type, typeOf(*e.else_), e.else_->loc);
 		}
+	}
+
+	void BasicTypingPass::visitJump(ast::Jump& j) {
+		AstVisitor::visitJump(j);
 
+		if (j.type == +ast::KeywordType::RET && j.expr && !returns.empty()) {
+			unify(returns.back(), typeOf(*j.expr), j.loc);
+		}
 	}
 
 
 	// Statements
+	void BasicTypingPass::visitVarAssign(ast::VarAssign& v) {
+		AstVisitor::visitVarAssign(v);
+
+		auto value = typeOf(*v.expr);
+		bindPattern(*v.name, value, v.loc);
+
+		if (v.type) {
+			bindAnnotation(value, *v.type, v.loc);
+		}
+	}
+
+
+	// Expressions
+	void BasicTypingPass::visitInAssign(ast::InAssign& in) {
+		auto parent_scope = current;
+		current = *dictionary.scope_of.at(in.id);
+
+		AstVisitor::visitInAssign(in);
+		unify(typeOf(in), typeOf(*in.expr), in.loc);
+
+		current = parent_scope;
+	}
+
+	void BasicTypingPass::visitVariable(ast::Variable& v) {
+		AstVisitor::visitVariable(v);
+
+		if (auto def_table = dictionary.def_table.at(v.id)) {
+			auto& part = *v.name->elems.back();
+			unify(typeOf(v), typeOf(*def_table, part.name, dictionary.ssa_index.at(part.id)), v.loc);
+		}
+	}
+
+	void BasicTypingPass::visitUnOpCall(ast::UnOpCall& u) {
+		AstVisitor::visitUnOpCall(u);
+
+		if (u.op->name == "!") {
+			bind(typeOf(*u.expr), dictionary.core.Bool, u.loc);
+			bind(typeOf(u), dictionary.core.Bool, u.loc);
+
+		} else {
+			unify(typeOf(u), typeOf(*u.expr), u.loc);
+		}
+	}
+
 	void BasicTypingPass::visitBinOpCall(ast::BinOpCall& b) {
 		AstVisitor::visitBinOpCall(b);
 
-		auto* lhs_type = b.lhs->type.get();
-		auto* rhs_type = b.rhs->type.get();
+		auto lhs = typeOf(*b.lhs);
+		auto rhs = typeOf(*b.rhs);
+
+		if (b.op == "&&" || b.op == "||") {
+			bind(lhs, dictionary.core.Bool, b.lhs->loc);
+			bind(rhs, dictionary.core.Bool, b.rhs->loc);
+			bind(typeOf(b), dictionary.core.Bool, b.loc);
+			return;
+		}
+
+		if (!unifier.unify(lhs, rhs)) {
+			auto[lhs_type, rhs_type] = unifier.conflict();
+			state.log(ID::err, "Type: Operator `{}` is not defined for `{}, {}` <at {}>", b.op, typeName(lhs_type), typeName(rhs_type), b.loc);
+		}
+
+		if (b.op == "==" || b.op == "!=" || b.op == "<" || b.op == "<=" || b.op == ">" || b.op == ">=") {
+			bind(typeOf(b), dictionary.core.Bool, b.loc);
+		} else {
+			unify(typeOf(b), lhs, b.loc);
+		}
+	}
 
-		if (lhs_type != rhs_type && lhs_type && rhs_type) {
-			state.log(ID::err, "Type: Operator `{}` is not defined for `{}, {}` <at {}>", b.op, *lhs_type, *rhs_type, b.loc);
+	void BasicTypingPass::visitIndex(ast::Index& i) {
+		AstVisitor::visitIndex(i);
+
+		// `a.b.c` is also how members are accessed, so the chain is only indexing if every index is already known to be an `Int`
+		// NOTE: Any other chain is left untyped (codegen reports it if it isn't an array after all)
+		auto is_index = [&](auto& expr) { return unifier.resolve(typeOf(*expr), dictionary.types) == dictionary.core.Int; };
+		if (!std::all_of(std::next(i.elems.begin()), i.elems.end(), is_index)) {
+			return;
+		}
+
+		// `xs.i.j` indexes `xs` by `i`, and then that element by `j`
+		auto indexed = typeOf(*i.elems.front());
+		for (auto iter = std::next(i.elems.begin()); iter != i.elems.end(); ++iter) {
+			auto elem = unifier.fresh();
+			unify(indexed, unifier.array(elem), (*iter)->loc);
+			indexed = elem;
+		}
+
+		unify(typeOf(i), indexed, i.loc);
+	}
+
+	void BasicTypingPass::visitFnCall(ast::FnCall& f) {
+		AstVisitor::visitFnCall(f);
+
+		std::vector<TypeVar> args;
+		if (f.arguments) {
+			for (auto& arg : f.arguments->elems) {
+				args.push_back(typeOf(*arg));
+			}
 		}
+
+		unify(typeOf(*f.callee), unifier.function(std::move(args), typeOf(f)), f.loc);
 	}
-}
\ No newline at end of file
+}
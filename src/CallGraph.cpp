@@ -0,0 +1,203 @@
+#include "analysis/CallGraph.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace spero::analysis {
+
+	size_t CallGraph::add(compiler::ast::NodeId fn) {
+		auto[iter, inserted] = node_index.try_emplace(fn, nodes.size());
+		if (inserted) {
+			if (!free_nodes.empty()) {
+				iter->second = free_nodes.back();
+				free_nodes.pop_back();
+				nodes[iter->second] = fn;
+
+			} else {
+				nodes.push_back(fn);
+				edges.emplace_back();
+			}
+		}
+
+		return iter->second;
+	}
+
+	void CallGraph::addEdge(compiler::ast::NodeId caller, compiler::ast::NodeId callee) {
+		auto from = add(caller);
+		auto to = add(callee);
+		edges[from].push_back(to);
+	}
+	void CallGraph::addGlobalReference(compiler::ast::NodeId ref, compiler::ast::NodeId callee) {
+		global_refs[ref] = add(callee);
+	}
+
+	void CallGraph::forget(compiler::ast::NodeId id) {
+		global_refs.erase(id);
+
+		if (auto iter = node_index.find(id); iter != node_index.end()) {
+			nodes[iter->second] = removed;
+			edges[iter->second].clear();
+			forgotten.push_back(iter->second);
+			node_index.erase(iter);
+		}
+	}
+
+	void CallGraph::computeComponents() {
+		static constexpr size_t unvisited = std::numeric_limits<size_t>::max();
+
+		sccs.clear();
+		scc_of.assign(nodes.size(), unvisited);
+		scc_waves.clear();
+
+		// Drop the references to forgotten functions, only then can their slots be reused
+		auto isRemoved = [&](size_t node) { return nodes[node] == removed; };
+		for (auto& callees : edges) {
+			callees.erase(std::remove_if(callees.begin(), callees.end(), isRemoved), callees.end());
+		}
+		for (auto iter = global_refs.begin(); iter != global_refs.end();) {
+			iter = isRemoved(iter->second) ? global_refs.erase(iter) : std::next(iter);
+		}
+		free_nodes.insert(free_nodes.end(), forgotten.begin(), forgotten.end());
+		forgotten.clear();
+
+		// Tarjan's algorithm, with an explicit stack so deep call chains can't overflow the native one
+		// Tarjan finishes a component only after every component it can reach, so `sccs` is already ordered callees first
+		std::vector<size_t> index(nodes.size(), unvisited), lowlink(nodes.size());
+		std::vector<size_t> stack;
+		std::vector<char> on_stack(nodes.size(), false);
+		std::vector<std::pair<size_t, size_t>> work;			// (node, next edge to visit)
+		size_t counter = 0;
+
+		for (size_t root = 0; root != nodes.size(); ++root) {
+			if (index[root] != unvisited || isRemoved(root)) {
+				continue;
+			}
+
+			work.emplace_back(root, 0);
+			while (!work.empty()) {
+				auto&[node, edge] = work.back();
+
+				if (edge == 0) {
+					index[node] = lowlink[node] = counter++;
+					stack.push_back(node);
+					on_stack[node] = true;
+				}
+
+				// Descend into the next unvisited callee
+				if (edge != edges[node].size()) {
+					auto callee = edges[node][edge++];
+					if (index[callee] == unvisited) {
+						work.emplace_back(callee, 0);
+					} else if (on_stack[callee]) {
+						lowlink[node] = std::min(lowlink[node], index[callee]);
+					}
+
+					continue;
+				}
+
+				// Every callee has been visited, so `node` is done
+				auto done = node;
+				work.pop_back();
+
+				if (lowlink[done] == index[done]) {
+					auto& scc = sccs.emplace_back();
+					size_t member;
+					do {
+						member = stack.back();
+						stack.pop_back();
+						on_stack[member] = false;
+
+						scc_of[member] = sccs.size() - 1;
+						scc.push_back(nodes[member]);
+					} while (member != done);
+				}
+
+				if (!work.empty()) {
+					auto parent = work.back().first;
+					lowlink[parent] = std::min(lowlink[parent], lowlink[done]);
+				}
+			}
+		}
+
+		// A component can only be processed once everything it refers to is
+		// So its wave is one past the latest wave of the components it refers to
+		std::vector<size_t> wave_of(sccs.size(), 0);
+		for (size_t scc = 0; scc != sccs.size(); ++scc) {
+			for (auto fn : sccs[scc]) {
+				for (auto callee : edges[node_index.at(fn)]) {
+					if (scc_of[callee] != scc) {
+						wave_of[scc] = std::max(wave_of[scc], wave_of[scc_of[callee]] + 1);
+					}
+				}
+			}
+
+			if (wave_of[scc] >= scc_waves.size()) {
+				scc_waves.resize(wave_of[scc] + 1);
+			}
+			scc_waves[wave_of[scc]].push_back(scc);
+		}
+	}
+
+	opt_t<size_t> CallGraph::componentOf(compiler::ast::NodeId fn) const {
+		auto iter = node_index.find(fn);
+		if (iter == node_index.end() || iter->second >= scc_of.size()) {
+			return std::nullopt;
+		}
+
+		return scc_of[iter->second];
+	}
+
+	std::vector<compiler::ast::NodeId> CallGraph::callees(compiler::ast::NodeId fn) const {
+		std::vector<compiler::ast::NodeId> result;
+		if (auto iter = node_index.find(fn); iter != node_index.end()) {
+			for (auto callee : edges[iter->second]) {
+				result.push_back(nodes[callee]);
+			}
+		}
+
+		return result;
+	}
+
+	bool CallGraph::isRecursive(size_t component) const {
+		if (sccs[component].size() > 1) {
+			return true;
+		}
+
+		auto node = node_index.at(sccs[component].front());
+		return std::find(edges[node].begin(), edges[node].end(), node) != edges[node].end();
+	}
+
+	std::unordered_set<compiler::ast::NodeId> CallGraph::reachableFrom(const std::vector<compiler::ast::NodeId>& roots) const {
+		std::vector<char> seen(nodes.size(), false);
+		std::vector<size_t> work;
+		for (auto&[ref, callee] : global_refs) {
+			work.push_back(callee);
+		}
+		for (auto root : roots) {
+			if (auto iter = node_index.find(root); iter != node_index.end()) {
+				work.push_back(iter->second);
+			}
+		}
+
+		std::unordered_set<compiler::ast::NodeId> reachable;
+		while (!work.empty()) {
+			auto node = work.back();
+			work.pop_back();
+
+			if (seen[node]) {
+				continue;
+			}
+			seen[node] = true;
+			reachable.insert(nodes[node]);
+
+			for (auto callee : edges[node]) {
+				if (!seen[callee]) {
+					work.push_back(callee);
+				}
+			}
+		}
+
+		return reachable;
+	}
+
+}
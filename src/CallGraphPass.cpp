@@ -0,0 +1,56 @@
+#include "analysis/CallGraphPass.h"
+
+namespace spero::analysis {
+	using namespace compiler;
+
+	CallGraphPass::CallGraphPass(AnalysisState& dict) : dictionary{ dict } {}
+
+	void CallGraphPass::finalize() {
+		dictionary.calls.computeComponents();
+	}
+
+
+	// Atoms
+	void CallGraphPass::visitFunction(ast::Function& f) {
+		if (enclosing.empty()) {
+			dictionary.calls.add(f.id);
+		} else {
+			dictionary.calls.addEdge(enclosing.back(), f.id);
+		}
+
+		enclosing.push_back(f.id);
+		AstVisitor::visitFunction(f);
+		enclosing.pop_back();
+	}
+
+
+	// Names
+	void CallGraphPass::visitVariable(ast::Variable& v) {
+		auto def_table = dictionary.def_table.at(v.id);
+		if (!def_table) {
+			return;
+		}
+
+		auto& part = *v.name->elems.back();
+		auto ssa_index = dictionary.ssa_index.at(part.id);
+		auto sym = dictionary.arena[*def_table].get(part.name, nullptr, ssa_index);
+		if (!sym) {
+			return;
+		}
+
+		if (auto* info = std::get_if<ref_t<SymbolInfo>>(&*sym)) {
+			auto* fn = dynamic_cast<ast::Function*>(info->get().definition);
+			if (!fn) {
+				return;
+			}
+
+			// References outside of any function (ie. in a global's initializer) keep the function alive on their own
+			if (enclosing.empty()) {
+				dictionary.calls.addGlobalReference(v.id, fn->id);
+			} else {
+				dictionary.calls.addEdge(enclosing.back(), fn->id);
+			}
+		}
+	}
+
+}
@@ -6,6 +6,12 @@
 #include <llvm/Support/FileSystem.h>
 #pragma warning(pop)
 
+#include <fstream>
+#include <sstream>
+
+#include "parser/chunks.h"
+#include "parser/serialize.h"
+
 using namespace spero;
 using namespace spero::compiler;
 
@@ -46,17 +52,64 @@ void CompilationDriver::triggerClangCompile() {
 	}
 }
 
+static bool readFile(CompilationState& state, const std::string& file, std::string& contents) {
+	std::ifstream in{ file, std::ios::binary };
+	if (!in) {
+		state.log(ID::err, "Unable to open input file `{}`", file);
+		return false;
+	}
+
+	std::ostringstream buffer;
+	buffer << in.rdbuf();
+	contents = buffer.str();
+	return true;
+}
+
+void CompilationDriver::applyEdit(parser::ParsingMode parser_mode, const std::string& input, const std::string& edited) {
+	std::string before = input, after;
+	if (parser_mode == parser::ParsingMode::FILE && !readFile(state, input, before)) {
+		return;
+	}
+	if (!readFile(state, edited, after)) {
+		return;
+	}
+
+	if (parser::isSerializedAst(before)) {
+		state.log(ID::err, "`{}` is a binary ast, so it can't be edited", input);
+		return;
+	}
+
+	recompile(before, parser::diffSources(before, after));
+}
+
 bool CompilationDriver::compile() try {
 	const GET_PERMISSIONS(state);
 
-	// frontend
-	parseInput(parser_mode, state.files()[0]);
+	if (state.streamStatements()) {
+		// frontend + analysis + backend, interleaved per statement
+		streamInput(parser_mode, state.files()[0]);
+
+	} else {
+		// frontend (the input may be a previously saved ast)
+		auto& input = state.files()[0];
+		if (parser_mode != parser::ParsingMode::FILE || !loadAst(input)) {
+			parseInput(parser_mode, input);
+		}
+
+		if (auto output = state.astOutput(); !output.empty()) {
+			saveAst(output);
+		}
+
+		// analysis
+		analyzeAst();
 
-	// analysis
-	analyzeAst();
+		// backend (an edit then only analyzes and translates the statements it affects again, into the same module)
+		translateAstToLlvm();
+		if (auto edited = state.editedInput(); !edited.empty()) {
+			applyEdit(parser_mode, input, edited);
+		}
+	}
 
-	// backend
-	translateAstToLlvm();
 	optimizeLlvm();
 
 	// compilation
@@ -29,6 +29,12 @@ namespace spero::compiler {
 	llvm::LLVMContext& CompilationState::getContext() {
 		return *context;
 	}
+	string::Interner& CompilationState::strings() {
+		return interner;
+	}
+	ast::NodeIds& CompilationState::nodeIds() {
+		return node_ids;
+	}
 	OptimizationLevel CompilationState::optimizationLevel() {
 		return opt_level;
 	}
@@ -0,0 +1,267 @@
+#include "analysis/ConstEvaluator.h"
+
+#include <utility>
+
+namespace spero::analysis {
+	using namespace compiler;
+
+	ConstEvaluator::ConstEvaluator(AnalysisState& dict) : dictionary{ dict } {}
+
+	opt_t<ConstValue> ConstEvaluator::call(ast::Function& fn, const std::vector<ConstValue>& args) {
+		steps = bindings = 0;
+		failed = false;
+
+		auto result = evalCall(fn, args);
+
+		frames.clear();
+		current = GLOBAL_SYM_INDEX;
+		return failed ? std::nullopt : result;
+	}
+
+	ast::Function* ConstEvaluator::globalFunction(ast::ValExpr& callee) {
+		auto* var = dynamic_cast<ast::Variable*>(&callee);
+		if (!var || dictionary.def_table.at(var->id) != GLOBAL_SYM_INDEX) {
+			return nullptr;
+		}
+
+		auto& part = *var->name->elems.back();
+		auto ssa_index = dictionary.ssa_index.at(part.id);
+		auto sym = dictionary.arena[GLOBAL_SYM_INDEX].get(part.name, nullptr, ssa_index);
+		if (!sym) {
+			return nullptr;
+		}
+
+		auto* info = std::get_if<ref_t<SymbolInfo>>(&*sym);
+		return info && !info->get().is_mut ? dynamic_cast<ast::Function*>(info->get().definition) : nullptr;
+	}
+
+
+	// Binding helpers
+	opt_t<ConstEvaluator::Binding> ConstEvaluator::bindingOf(ast::Variable& var) {
+		auto def_table = dictionary.def_table.at(var.id);
+		auto& part = *var.name->elems.back();
+		auto ssa_index = dictionary.ssa_index.at(part.id);
+
+		if (!def_table || !ssa_index) {
+			return std::nullopt;
+		}
+
+		return Binding{ *def_table, part.name, *ssa_index };
+	}
+
+	bool ConstEvaluator::bind(const Binding& binding, ConstValue value) {
+		auto[iter, inserted] = frames.back().insert_or_assign(binding, value);
+		if (inserted && ++bindings > max_bindings) {
+			fail();
+		}
+
+		return !failed;
+	}
+
+	opt_t<ConstValue> ConstEvaluator::fail() {
+		failed = true;
+		return std::nullopt;
+	}
+
+
+	opt_t<ConstValue> ConstEvaluator::evalCall(ast::Function& fn, const std::vector<ConstValue>& args) {
+		if (fn.args.size() != args.size() || frames.size() == max_depth) {
+			return fail();
+		}
+
+		// Pure functions always give the same result for the same arguments
+		auto key = std::make_pair(fn.id, args);
+		if (auto iter = results.find(key); iter != results.end()) {
+			return iter->second ? iter->second : fail();
+		}
+
+		auto parent_scope = current;
+		current = GLOBAL_SYM_INDEX;
+		frames.emplace_back();
+
+		for (size_t i = 0; i != args.size() && !failed; ++i) {
+			auto& arg = *fn.args[i];
+			if (auto ssa_index = dictionary.ssa_index.at(arg.id)) {
+				bind(Binding{ GLOBAL_SYM_INDEX, arg.name->name, *ssa_index }, args[i]);
+			} else {
+				fail();
+			}
+		}
+
+		auto result = eval(*fn.body);
+
+		bindings -= frames.back().size();
+		frames.pop_back();
+		current = parent_scope;
+
+		// Failures are remembered too, so a call that runs into the limits only does so once
+		results[key] = failed ? std::nullopt : result;
+		return results[key];
+	}
+
+	opt_t<ConstValue> ConstEvaluator::eval(ast::Ast& node) {
+		if (failed) {
+			return std::nullopt;
+		}
+		if (++steps > max_steps) {
+			return fail();
+		}
+
+		// Anything that was already folded doesn't need to be evaluated
+		if (auto value = dictionary.const_of.at(node.id)) {
+			return value;
+		}
+
+		if (auto* var = dynamic_cast<ast::Variable*>(&node)) {
+			if (auto binding = bindingOf(*var)) {
+				auto& frame = frames.back();
+				if (auto iter = frame.find(*binding); iter != frame.end()) {
+					return iter->second;
+				}
+			}
+
+			return fail();
+
+		} else if (auto* un = dynamic_cast<ast::UnOpCall*>(&node)) {
+			auto expr = eval(*un->expr);
+			return expr ? evalUnary(un->op->name, *expr) : fail();
+
+		} else if (auto* bin = dynamic_cast<ast::BinOpCall*>(&node)) {
+			// Assignments are only pure if they are to a local of the evaluated call
+			if (bin->op == string::names::assign) {
+				auto* var = dynamic_cast<ast::Variable*>(bin->lhs.get());
+				auto binding = var ? bindingOf(*var) : std::nullopt;
+				if (!binding || frames.back().count(*binding) == 0) {
+					return fail();
+				}
+
+				auto rhs = eval(*bin->rhs);
+				if (!rhs || !bind(*binding, *rhs)) {
+					return fail();
+				}
+				return rhs;
+			}
+
+			auto lhs = eval(*bin->lhs);
+			if (!lhs) {
+				return fail();
+			}
+
+			// `&&` and `||` only evaluate the right side if they have to
+			if (auto* l = std::get_if<bool>(&*lhs); l && ((bin->op == "&&" && !*l) || (bin->op == "||" && *l))) {
+				return lhs;
+			}
+
+			auto rhs = eval(*bin->rhs);
+			auto result = rhs ? evalBinary(bin->op, *lhs, *rhs) : std::nullopt;
+			return result ? result : fail();
+
+		} else if (auto* call = dynamic_cast<ast::FnCall*>(&node)) {
+			auto* fn = globalFunction(*call->callee);
+			if (!fn) {
+				return fail();
+			}
+
+			std::vector<ConstValue> args;
+			if (call->arguments) {
+				for (auto& arg : call->arguments->elems) {
+					if (auto value = eval(*arg)) {
+						args.push_back(*value);
+					} else {
+						return fail();
+					}
+				}
+			}
+
+			return evalCall(*fn, args);
+
+		} else if (auto* block = dynamic_cast<ast::Block*>(&node)) {
+			auto parent_scope = current;
+			if (auto scope = dictionary.scope_of.at(block->id)) {
+				current = *scope;
+			}
+
+			opt_t<ConstValue> result;
+			for (auto& stmt : block->elems) {
+				result = eval(*stmt);
+				if (failed) {
+					break;
+				}
+			}
+
+			current = parent_scope;
+			return result;
+
+		} else if (auto* assign = dynamic_cast<ast::VarAssign*>(&node)) {
+			// TODO: Destructuring assignments aren't evaluated yet
+			auto* name = dynamic_cast<ast::AssignName*>(assign->name.get());
+			auto ssa_index = name ? dictionary.ssa_index.at(name->id) : std::nullopt;
+			if (!ssa_index || dynamic_cast<ast::Function*>(assign->expr.get())) {
+				return fail();
+			}
+
+			auto value = eval(*assign->expr);
+			if (!value || !bind(Binding{ current, name->var->name, *ssa_index }, *value)) {
+				return fail();
+			}
+			return std::nullopt;
+
+		} else if (auto* in = dynamic_cast<ast::InAssign*>(&node)) {
+			auto parent_scope = current;
+			if (auto scope = dictionary.scope_of.at(in->id)) {
+				current = *scope;
+			}
+
+			eval(*in->bind);
+			auto result = eval(*in->expr);
+
+			current = parent_scope;
+			return result;
+
+		} else if (auto* ifs = dynamic_cast<ast::IfElse*>(&node)) {
+			for (auto& branch : ifs->elems) {
+				auto test = eval(*branch->test);
+				auto* taken = test ? std::get_if<bool>(&*test) : nullptr;
+				if (!taken) {
+					return fail();
+				}
+
+				if (*taken) {
+					return eval(*branch->body);
+				}
+			}
+
+			return ifs->else_ ? eval(*ifs->else_) : std::nullopt;
+
+		} else if (auto* loop = dynamic_cast<ast::While*>(&node)) {
+			while (true) {
+				auto test = eval(*loop->test);
+				auto* running = test ? std::get_if<bool>(&*test) : nullptr;
+				if (!running) {
+					return fail();
+				}
+				if (!*running) {
+					return std::nullopt;
+				}
+
+				eval(*loop->body);
+				if (failed) {
+					return std::nullopt;
+				}
+			}
+
+		} else if (dynamic_cast<ast::Jump*>(&node)) {
+			// TODO: Evaluate `break`, `continue` and `return` (calls that jump are left to run time for now)
+			return fail();
+
+		} else if (auto* annot = dynamic_cast<ast::TypeAnnotation*>(&node)) {
+			return eval(*annot->expression);
+
+		} else if (auto* tuple = dynamic_cast<ast::Tuple*>(&node); tuple && tuple->elems.size() == 1) {
+			return eval(*tuple->elems.front());
+		}
+
+		return fail();
+	}
+
+}
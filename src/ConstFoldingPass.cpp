@@ -0,0 +1,137 @@
+#include "analysis/ConstFoldingPass.h"
+
+namespace spero::analysis {
+	using namespace compiler;
+
+	ConstFoldingPass::ConstFoldingPass(AnalysisState& dict) : dictionary{ dict }, evaluator{ dict } {}
+
+
+	// Literals
+	void ConstFoldingPass::visitBool(ast::Bool& b) {
+		dictionary.const_of[b.id] = b.val;
+	}
+	void ConstFoldingPass::visitFloat(ast::Float& f) {
+		dictionary.const_of[f.id] = f.val;
+	}
+	void ConstFoldingPass::visitInt(ast::Int& i) {
+		dictionary.const_of[i.id] = static_cast<int64_t>(i.val);
+	}
+	void ConstFoldingPass::visitChar(ast::Char& c) {
+		dictionary.const_of[c.id] = c.val;
+	}
+
+
+	// Atoms
+	void ConstFoldingPass::visitTuple(ast::Tuple& t) {
+		AstVisitor::visitTuple(t);
+
+		// Only parenthesized expressions have a value that can be folded
+		if (t.elems.size() == 1) {
+			if (auto value = dictionary.const_of.at(t.elems.front()->id)) {
+				dictionary.const_of[t.id] = *value;
+			}
+		}
+	}
+
+
+	// Names
+	void ConstFoldingPass::visitVariable(ast::Variable& v) {
+		AstVisitor::visitVariable(v);
+
+		auto def_table = dictionary.def_table.at(v.id);
+		if (!def_table) {
+			return;
+		}
+
+		auto& part = *v.name->elems.back();
+		auto ssa_index = dictionary.ssa_index.at(part.id);
+		auto sym = dictionary.arena[*def_table].get(part.name, nullptr, ssa_index);
+		if (!sym) {
+			return;
+		}
+
+		auto* info = std::get_if<ref_t<SymbolInfo>>(&*sym);
+		if (!info || info->get().is_mut) {
+			return;
+		}
+
+		// Arguments and functions have no definition (or aren't values that can be folded)
+		auto* def = dynamic_cast<ast::ValExpr*>(info->get().definition);
+		if (!def || dynamic_cast<ast::Function*>(def)) {
+			return;
+		}
+
+		// Uses may come before the definition, so evaluate it now if the pass hasn't already
+		if (evaluated.insert(def->id).second) {
+			def->accept(*this);
+		}
+
+		if (auto value = dictionary.const_of.at(def->id)) {
+			dictionary.const_of[v.id] = *value;
+		}
+	}
+
+
+	// Decorations
+	void ConstFoldingPass::visitTypeAnnotation(ast::TypeAnnotation& t) {
+		AstVisitor::visitTypeAnnotation(t);
+
+		if (auto value = dictionary.const_of.at(t.expression->id)) {
+			dictionary.const_of[t.id] = *value;
+		}
+	}
+
+
+	// Expressions
+	void ConstFoldingPass::visitUnOpCall(ast::UnOpCall& u) {
+		AstVisitor::visitUnOpCall(u);
+
+		if (auto expr = dictionary.const_of.at(u.expr->id)) {
+			if (auto value = evalUnary(u.op->name, *expr)) {
+				dictionary.const_of[u.id] = *value;
+			}
+		}
+	}
+
+	void ConstFoldingPass::visitBinOpCall(ast::BinOpCall& b) {
+		AstVisitor::visitBinOpCall(b);
+
+		auto lhs = dictionary.const_of.at(b.lhs->id);
+		auto rhs = dictionary.const_of.at(b.rhs->id);
+		if (lhs && rhs) {
+			if (auto value = evalBinary(b.op, *lhs, *rhs)) {
+				dictionary.const_of[b.id] = *value;
+			}
+		}
+	}
+
+	void ConstFoldingPass::visitFnCall(ast::FnCall& f) {
+		AstVisitor::visitFnCall(f);
+
+		auto* fn = evaluator.globalFunction(*f.callee);
+		if (!fn) {
+			return;
+		}
+
+		std::vector<ConstValue> args;
+		if (f.arguments) {
+			for (auto& arg : f.arguments->elems) {
+				if (auto value = dictionary.const_of.at(arg->id)) {
+					args.push_back(*value);
+				} else {
+					return;
+				}
+			}
+		}
+
+		// The function's own body may not have been folded yet (ie. if it's defined after the call)
+		if (evaluated.insert(fn->body->id).second) {
+			fn->body->accept(*this);
+		}
+
+		if (auto value = evaluator.call(*fn, args)) {
+			dictionary.const_of[f.id] = *value;
+		}
+	}
+
+}
@@ -0,0 +1,91 @@
+#include "analysis/DependencyPass.h"
+
+namespace spero::analysis {
+
+	using namespace compiler;
+
+	void DependencyPass::collect(ast::Ast& stmt) {
+		depth = 0;
+		locals.clear();
+		used.clear();
+		declared.clear();
+		required.clear();
+		arguments.clear();
+
+		stmt.accept(*this);
+
+		for (auto& name : used) {
+			if (declared.count(name) == 0 && locals.count(name) == 0) {
+				required.insert(name);
+			}
+		}
+	}
+
+
+	// Decorations
+	void DependencyPass::visitArgument(ast::Argument& arg) {
+		locals.insert(arg.name->name);
+
+		// Only a function outside of any scope has `depth == 1` while its arguments are visited
+		if (depth == 1) {
+			arguments.insert(arg.name->name);
+		}
+		AstVisitor::visitArgument(arg);
+	}
+
+
+	// Atoms
+	void DependencyPass::visitBlock(ast::Block& b) {
+		++depth;
+		AstVisitor::visitBlock(b);
+		--depth;
+	}
+	void DependencyPass::visitFunction(ast::Function& f) {
+		++depth;
+		AstVisitor::visitFunction(f);
+		--depth;
+	}
+
+
+	// Control
+	void DependencyPass::visitFor(ast::For& f) {
+		if (auto* var = dynamic_cast<ast::VarPattern*>(f.pattern.get())) {
+			locals.insert(var->name->elems.back()->name);
+		}
+
+		++depth;
+		AstVisitor::visitFor(f);
+		--depth;
+	}
+
+
+	// Names
+	void DependencyPass::visitVariable(ast::Variable& v) {
+		used.insert(v.name->elems.front()->name);
+		AstVisitor::visitVariable(v);
+	}
+	void DependencyPass::visitAssignName(ast::AssignName& n) {
+		(depth == 0 ? declared : locals).insert(n.var->name);
+		AstVisitor::visitAssignName(n);
+	}
+
+
+	// Statements
+	void DependencyPass::visitInAssign(ast::InAssign& in) {
+		++depth;
+		AstVisitor::visitInAssign(in);
+		--depth;
+	}
+	void DependencyPass::visitTypeAssign(ast::TypeAssign& t) {
+		// The type's name is bound in the enclosing scope, but its members are not
+		visitInterface(t);
+
+		++depth;
+		for (auto&& constructor : t.cons) {
+			constructor->accept(*this);
+		}
+		t.body->accept(*this);
+		--depth;
+	}
+
+}
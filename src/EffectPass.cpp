@@ -0,0 +1,168 @@
+#include "analysis/EffectPass.h"
+
+#include <algorithm>
+
+namespace spero::analysis {
+	using namespace compiler;
+
+	static Effect join(Effect lhs, Effect rhs) {
+		return Effect::_from_integral(std::max(lhs._to_integral(), rhs._to_integral()));
+	}
+
+	EffectPass::EffectPass(AnalysisState& dict) : dictionary{ dict } {}
+
+	void EffectPass::finalize() {
+		auto& calls = dictionary.calls;
+
+		// Components are ordered callees first, so every callee outside of the component is already classified
+		// Functions in the same component may call each other, so they all share the component's effect
+		for (auto& component : calls.components()) {
+			// Components without a visited function keep the effects they were given before (ie. by an earlier batch of statements)
+			auto visited = [&](auto fn) { return local_effects.count(fn) != 0; };
+			if (std::none_of(component.begin(), component.end(), visited)) {
+				continue;
+			}
+
+			Effect effect = Effect::PURE;
+
+			for (auto fn : component) {
+				if (auto iter = local_effects.find(fn); iter != local_effects.end()) {
+					effect = join(effect, iter->second);
+				}
+
+				for (auto callee : calls.callees(fn)) {
+					if (auto callee_effect = dictionary.effect_of.at(callee)) {
+						effect = join(effect, *callee_effect);
+					}
+				}
+			}
+
+			for (auto fn : component) {
+				dictionary.effect_of[fn] = effect;
+			}
+		}
+	}
+
+
+	// Helpers
+	void EffectPass::addEffect(Effect effect) {
+		if (!enclosing.empty()) {
+			enclosing.back().effect = join(enclosing.back().effect, effect);
+		}
+	}
+
+	bool EffectPass::isLocal(ast::Variable& var) {
+		auto def_table = dictionary.def_table.at(var.id);
+		if (!def_table || enclosing.empty()) {
+			return false;
+		}
+
+		auto& fn = enclosing.back();
+		if (fn.tables.count(*def_table)) {
+			return true;
+		}
+
+		// Arguments are declared in the scope enclosing the function, so they have to be checked individually
+		auto& part = *var.name->elems.back();
+		auto ssa_index = dictionary.ssa_index.at(part.id);
+		return ssa_index && fn.args.count(Binding{ *def_table, part.name, *ssa_index });
+	}
+
+	SymbolInfo* EffectPass::symbolOf(ast::Variable& var) {
+		auto def_table = dictionary.def_table.at(var.id);
+		if (!def_table) {
+			return nullptr;
+		}
+
+		auto& part = *var.name->elems.back();
+		auto ssa_index = dictionary.ssa_index.at(part.id);
+		auto sym = dictionary.arena[*def_table].get(part.name, nullptr, ssa_index);
+		if (!sym) {
+			return nullptr;
+		}
+
+		auto* info = std::get_if<ref_t<SymbolInfo>>(&*sym);
+		return info ? &info->get() : nullptr;
+	}
+
+
+	// Atoms
+	void EffectPass::visitArray(ast::Array& a) {
+		AstVisitor::visitArray(a);
+
+		// Arrays of constants are emitted once and stack arrays die with the call, anything else is `malloc`ed (see `LlvmIrGenerator::visitArray`)
+		auto folded = [&](auto& elem) { return dictionary.const_of.at(elem->id).has_value(); };
+		if (!dictionary.local_array.at(a.id).value_or(false) && !std::all_of(a.elems.begin(), a.elems.end(), folded)) {
+			addEffect(Effect::WRITES);
+		}
+	}
+	void EffectPass::visitFunction(ast::Function& f) {
+		auto& fn = enclosing.emplace_back();
+		fn.fn = f.id;
+		for (auto& arg : f.args) {
+			if (auto ssa_index = dictionary.ssa_index.at(arg->id)) {
+				fn.args.emplace(current, arg->name->name, *ssa_index);
+			}
+		}
+
+		AstVisitor::visitFunction(f);
+
+		local_effects.insert_or_assign(f.id, enclosing.back().effect);
+		enclosing.pop_back();
+	}
+
+
+	// Names
+	void EffectPass::visitVariable(ast::Variable& v) {
+		AstVisitor::visitVariable(v);
+
+		// Immutable bindings can't change between calls, so only reads of mutable state are observable
+		auto* info = symbolOf(v);
+		if (info && info->is_mut && !isLocal(v)) {
+			addEffect(Effect::READONLY);
+		}
+	}
+
+
+	// Expressions
+	void EffectPass::visitBlock(ast::Block& b) {
+		withScope(dictionary.scope_of.at(b.id), [&]() { AstVisitor::visitBlock(b); });
+	}
+	void EffectPass::visitBinOpCall(ast::BinOpCall& b) {
+		AstVisitor::visitBinOpCall(b);
+
+		if (b.op == string::names::assign) {
+			auto* var = dynamic_cast<ast::Variable*>(b.lhs.get());
+			if (!var || !isLocal(*var)) {
+				addEffect(Effect::WRITES);
+			}
+		}
+	}
+	void EffectPass::visitFnCall(ast::FnCall& f) {
+		AstVisitor::visitFnCall(f);
+
+		// Calls to known functions are accounted for by the call graph
+		auto* var = dynamic_cast<ast::Variable*>(f.callee.get());
+		auto* info = var ? symbolOf(*var) : nullptr;
+		if (!info || info->is_mut || !dynamic_cast<ast::Function*>(info->definition)) {
+			addEffect(Effect::UNKNOWN);
+		}
+	}
+	void EffectPass::visitIndex(ast::Index& i) {
+		AstVisitor::visitIndex(i);
+
+		// Arrays live in memory, so llvm can't treat a function that reads one as `readnone`
+		addEffect(Effect::READONLY);
+	}
+	void EffectPass::visitFor(ast::For& f) {
+		f.generator->accept(*this);
+		withScope(dictionary.scope_of.at(f.id), [&]() { f.body->accept(*this); });
+
+		// Iterating reads every element of the array
+		addEffect(Effect::READONLY);
+	}
+	void EffectPass::visitInAssign(ast::InAssign& in) {
+		withScope(dictionary.scope_of.at(in.id), [&]() { AstVisitor::visitInAssign(in); });
+	}
+
+}
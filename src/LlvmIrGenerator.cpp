@@ -2,15 +2,66 @@
 
 #include "util/parser.h"
 #include "util/ranges.h"
+
+#include <iterator>
+#include <utility>
 
 namespace spero::compiler::gen {
 	using namespace llvm;
+
+	// The same weights that clang gives `__builtin_expect`
+	static constexpr uint32_t likely_weight = 2000;
+	static constexpr uint32_t unlikely_weight = 1;
+
+	// Array storage is aligned for the widest vector loads that llvm generates by default
+	static constexpr uint64_t array_alignment = 16;
+
+	// Heap arrays start with a header that links them into the list of arrays their owner frees, it keeps the elements aligned
+	static constexpr int64_t array_header = array_alignment;
+
+	// Frees every array in the list that its argument points to, leaving the list empty
+	static Function* releaseArrays(Module& module) {
+		if (auto fn = module.getFunction("spero.release")) {
+			return fn;
+		}
+
+		auto& context = module.getContext();
+		auto void_type = Type::getVoidTy(context);
+		auto bytes_type = Type::getInt8PtrTy(context);
+		auto list_type = bytes_type->getPointerTo();
+
+		auto fn = Function::Create(FunctionType::get(void_type, { list_type }, false), GlobalValue::PrivateLinkage, "spero.release", module);
+		auto free_fn = module.getOrInsertFunction("free", FunctionType::get(void_type, { bytes_type }, false));
+
+		auto entry = BasicBlock::Create(context, "entry", fn);
+		auto test = BasicBlock::Create(context, "release.test", fn);
+		auto body = BasicBlock::Create(context, "release.body", fn);
+		auto exit = BasicBlock::Create(context, "release.exit", fn);
+		auto list = fn->getArg(0);
+
+		IRBuilder<> builder{ entry };
+		builder.CreateBr(test);
+
+		builder.SetInsertPoint(test);
+		auto array = builder.CreateLoad(bytes_type, list);
+		builder.CreateCondBr(builder.CreateIsNull(array), exit, body);
+
+		// The header of every array points to the next one
+		builder.SetInsertPoint(body);
+		builder.CreateStore(builder.CreateLoad(bytes_type, builder.CreateBitCast(array, list_type)), list);
+		builder.CreateCall(free_fn, { array });
+		builder.CreateBr(test);
+
+		builder.SetInsertPoint(exit);
+		builder.CreateRetVoid();
+		return fn;
+	}
 	
-	LlvmIrGenerator::LlvmIrGenerator(std::unique_ptr<llvm::Module> mod, analysis::SymArena& arena, CompilationState& state)
-		: state{ state }, context{ state.getContext() }, arena{ arena }, translation_unit{ mod ? std::move(mod) : std::make_unique<llvm::Module>("speroc", state.getContext()) }, builder{ state.getContext() }
+	LlvmIrGenerator::LlvmIrGenerator(std::unique_ptr<llvm::Module> mod, analysis::AnalysisState& dict, CompilationState& state)
+		: state{ state }, context{ state.getContext() }, dictionary{ dict }, arena{ dict.arena }, translation_unit{ mod ? std::move(mod) : std::make_unique<llvm::Module>("speroc", state.getContext()) }, builder{ state.getContext() }
 	{}
 
-	LlvmIrGenerator::LlvmIrGenerator(analysis::SymArena& arena, CompilationState& state) : LlvmIrGenerator{ nullptr, arena, state } {}
+	LlvmIrGenerator::LlvmIrGenerator(analysis::AnalysisState& dict, CompilationState& state) : LlvmIrGenerator{ nullptr, dict, state } {}
 
 	std::unique_ptr<llvm::Module> LlvmIrGenerator::finalize() {
 		return std::move(translation_unit);
@@ -26,48 +77,408 @@ namespace spero::compiler::gen {
 		codegen = last;
 		return ret;
 	}
+	Constant* LlvmIrGenerator::foldedConstant(ast::ValExpr& expr) {
+		auto value = dictionary.const_of.at(expr.id);
+		if (!value) {
+			return nullptr;
+		}
+
+		// Values are represented the same way as the corresponding literals
+		return std::visit([&](auto&& val) -> Constant* {
+			using T = std::decay_t<decltype(val)>;
+
+			if constexpr (std::is_same_v<T, bool>) {
+				return builder.getInt1(val);
+
+			} else if constexpr (std::is_same_v<T, char>) {
+				return builder.getInt8(val);
+
+			} else if constexpr (std::is_same_v<T, int64_t>) {
+				return builder.getInt64(val);
+
+			} else {
+				return ConstantFP::get(builder.getDoubleTy(), val);
+			}
+		}, *value);
+	}
+	Value* LlvmIrGenerator::truthValue(Value* val) {
+		// `Bool` values are already `i1`, but values that couldn't be typed may not be
+		if (val->getType()->isIntegerTy(1)) {
+			return val;
+		}
+
+		return builder.CreateICmpNE(val, ConstantInt::get(val->getType(), 0));
+	}
+	Type* LlvmIrGenerator::lowerType(const analysis::Type* type) {
+		if (!type) {
+			return builder.getInt32Ty();
+		}
+
+		// NOTE: Names are compared as `mut Int` is a distinct type from `Int`
+		switch (type->kind()) {
+			case analysis::TypeKind::NAMED:
+				if (type->name() == string::names::Int) {
+					return builder.getInt64Ty();
+				} else if (type->name() == string::names::Float) {
+					return builder.getDoubleTy();
+				} else if (type->name() == string::names::Bool) {
+					return builder.getInt1Ty();
+				} else if (type->name() == string::names::Char || type->name() == string::names::Byte) {
+					return builder.getInt8Ty();
+				}
+				break;
+
+			case analysis::TypeKind::FUNCTION: {
+				auto& parts = type->parts();
+				std::vector<Type*> args;
+				for (auto iter = parts.begin(); iter != parts.end() - 1; ++iter) {
+					args.push_back(lowerType(*iter));
+				}
+				return FunctionType::get(lowerType(parts.back()), args, false)->getPointerTo();
+			}
+
+			case analysis::TypeKind::ARRAY:
+				return StructType::get(context, { lowerType(type->parts().front())->getPointerTo(), builder.getInt64Ty() });
+
+			case analysis::TypeKind::TUPLE: {
+				std::vector<Type*> elems;
+				for (auto* part : type->parts()) {
+					elems.push_back(lowerType(part));
+				}
+				return StructType::get(context, elems);
+			}
+
+			default:
+				break;
+		}
+
+		// TODO: Lower user-defined types once they can be defined
+		return builder.getInt32Ty();
+	}
+	Type* LlvmIrGenerator::lowerTypeOf(ast::ValExpr& expr) {
+		return lowerType(dictionary.type_of.at(expr.id).value_or(nullptr));
+	}
+	Value* LlvmIrGenerator::coerce(Value* val, Type* type) {
+		auto from = val->getType();
+		if (from == type) {
+			return val;
+		}
+
+		if (from->isIntegerTy() && type->isIntegerTy()) {
+			// `true` widens to 1, not to -1
+			return builder.CreateIntCast(val, type, !from->isIntegerTy(1));
+		} else if (from->isIntegerTy() && type->isFloatingPointTy()) {
+			return builder.CreateSIToFP(val, type);
+		} else if (from->isFloatingPointTy() && type->isIntegerTy()) {
+			return builder.CreateFPToSI(val, type);
+		} else if (from->isFloatingPointTy() && type->isFloatingPointTy()) {
+			return builder.CreateFPCast(val, type);
+		} else if (from->isStructTy() && from->getStructNumElements() == 0) {
+			// Unit carries no information, so it stands in for the zero value of any type (ie. a function that ends in a loop)
+			return Constant::getNullValue(type);
+		} else if (from->isStructTy() && type->isStructTy() && from->getStructNumElements() == type->getStructNumElements()) {
+			// Tuples are converted element by element (ie. `(1, 2)` into an `(Int, Float)`)
+			Value* result = UndefValue::get(type);
+			for (unsigned i = 0; i != type->getStructNumElements(); ++i) {
+				auto elem = coerce(builder.CreateExtractValue(val, i), type->getStructElementType(i));
+				result = builder.CreateInsertValue(result, elem, i);
+			}
+			return result;
+		}
+
+		return val;
+	}
+	AllocaInst* LlvmIrGenerator::createEntryAlloca(Type* type, const Twine& name) {
+		// Allocas outside of the entry block are re-executed every time they're reached (ie. in loops)
+		// And mem2reg only promotes the allocas that are in the entry block
+		auto& entry = builder.GetInsertBlock()->getParent()->getEntryBlock();
+		IRBuilder<> entry_builder{ &entry, entry.begin() };
+		return entry_builder.CreateAlloca(type, nullptr, name);
+	}
+
+	MDNode* LlvmIrGenerator::expectedWeights(ast::Statement& s) {
+		for (auto& annot : s.annots) {
+			if (annot->name->name == "likely") {
+				return MDBuilder{ context }.createBranchWeights(likely_weight, unlikely_weight);
+			} else if (annot->name->name == "unlikely") {
+				return MDBuilder{ context }.createBranchWeights(unlikely_weight, likely_weight);
+			}
+		}
+
+		return nullptr;
+	}
+
+	MDNode* LlvmIrGenerator::loopMetadata(ast::Statement& s) {
+		std::vector<Metadata*> hints;
+		auto addHint = [&](const char* name, Constant* value) {
+			hints.push_back(MDNode::get(context, { MDString::get(context, name), ConstantAsMetadata::get(value) }));
+		};
+
+		for (auto& annot : s.annots) {
+			auto& name = annot->name->name;
+			auto* arg = annot->args && annot->args->elems.size() == 1 ? dynamic_cast<ast::Int*>(annot->args->elems.front().get()) : nullptr;
+			if (arg && arg->val <= 0) {
+				state.log(ID::err, "Loop annotation `@{}` expects a positive count <at {}>", name, annot->loc);
+				continue;
+			}
+
+			// `@vectorize` or `@vectorize(width)`
+			if (name == "vectorize") {
+				addHint("llvm.loop.vectorize.enable", builder.getTrue());
+				if (arg) {
+					addHint("llvm.loop.vectorize.width", builder.getInt32(static_cast<uint32_t>(arg->val)));
+				}
+
+			// `@unroll` leaves the count to llvm, `@unroll(n)` unrolls exactly `n` times
+			} else if (name == "unroll") {
+				if (arg) {
+					addHint("llvm.loop.unroll.count", builder.getInt32(static_cast<uint32_t>(arg->val)));
+				} else {
+					hints.push_back(MDNode::get(context, MDString::get(context, "llvm.loop.unroll.enable")));
+				}
+			}
+		}
+
+		if (hints.empty()) {
+			return nullptr;
+		}
+
+		// Loop ids have to be distinct and refer to themselves
+		hints.insert(hints.begin(), nullptr);
+		auto loop_id = MDNode::getDistinct(context, hints);
+		loop_id->replaceOperandWith(0, loop_id);
+		return loop_id;
+	}
+
+	// Whether the expression can be evaluated unconditionally, ie. it's cheap and can't have effects (or trap)
+	static bool isCheapAndPure(ast::ValExpr& expr, const analysis::AnalysisState& dictionary, size_t depth = 3) {
+		if (dictionary.const_of.at(expr.id) || dynamic_cast<ast::Variable*>(&expr)) {
+			return true;
+		} else if (depth == 0) {
+			return false;
+		}
+
+		if (auto* annot = dynamic_cast<ast::TypeAnnotation*>(&expr)) {
+			return isCheapAndPure(*annot->expression, dictionary, depth - 1);
+		} else if (auto* un = dynamic_cast<ast::UnOpCall*>(&expr)) {
+			return isCheapAndPure(*un->expr, dictionary, depth - 1);
+		} else if (auto* bin = dynamic_cast<ast::BinOpCall*>(&expr)) {
+			// Division by zero is undefined, so it can't be hoisted out of its branch
+			if (bin->op == string::names::assign || bin->op == "/" || bin->op == "%") {
+				return false;
+			}
+			return isCheapAndPure(*bin->lhs, dictionary, depth - 1) && isCheapAndPure(*bin->rhs, dictionary, depth - 1);
+		}
+
+		return false;
+	}
+
+	// The predicate that implements the comparison operator, if `op` is one
+	// NOTE: Floating point comparisons are ordered, except for `!=` (so only `!=` is true for NaN)
+	static opt_t<CmpInst::Predicate> comparisonPredicate(const String& op, bool is_float, bool is_unsigned) {
+		if (op == "==") {
+			return is_float ? CmpInst::FCMP_OEQ : CmpInst::ICMP_EQ;
+		} else if (op == "!=") {
+			return is_float ? CmpInst::FCMP_UNE : CmpInst::ICMP_NE;
+		} else if (op == "<") {
+			return is_float ? CmpInst::FCMP_OLT : is_unsigned ? CmpInst::ICMP_ULT : CmpInst::ICMP_SLT;
+		} else if (op == "<=") {
+			return is_float ? CmpInst::FCMP_OLE : is_unsigned ? CmpInst::ICMP_ULE : CmpInst::ICMP_SLE;
+		} else if (op == ">") {
+			return is_float ? CmpInst::FCMP_OGT : is_unsigned ? CmpInst::ICMP_UGT : CmpInst::ICMP_SGT;
+		} else if (op == ">=") {
+			return is_float ? CmpInst::FCMP_OGE : is_unsigned ? CmpInst::ICMP_UGE : CmpInst::ICMP_SGE;
+		}
+
+		return std::nullopt;
+	}
 
 	//
 	// Literals
 	//
 	void LlvmIrGenerator::visitBool(ast::Bool& b) {
-		// TODO: How to effectively represent boolean values in llvm ir ???
-		int llvm_bool_val = b.val ? -1 : 0;
-		codegen = llvm::ConstantInt::get(context, APInt(sizeof(llvm_bool_val) * 8, llvm_bool_val, true));
+		codegen = builder.getInt1(b.val);
 	}
 	void LlvmIrGenerator::visitByte(ast::Byte& b) {
-		codegen = ConstantInt::get(context, APInt(sizeof(b.val) * 8, b.val, false));
+		codegen = ConstantInt::get(builder.getInt8Ty(), b.val, false);
 	}
 	void LlvmIrGenerator::visitFloat(ast::Float& f) {
-		codegen = ConstantFP::get(context, APFloat(f.val));
+		codegen = ConstantFP::get(builder.getDoubleTy(), f.val);
 	}
 	void LlvmIrGenerator::visitInt(ast::Int& i) {
-		codegen = ConstantInt::get(context, APInt(sizeof(i.val) * 8, i.val, true));
+		// NOTE: `long` is only 32 bits on windows, but `Int` is always 64 bits
+		codegen = ConstantInt::get(builder.getInt64Ty(), i.val, true);
 	}
 	void LlvmIrGenerator::visitChar(ast::Char& c) {
-		codegen = ConstantInt::get(context, APInt(8, c.val, false));
+		codegen = builder.getInt8(c.val);
 	}
 
 	//
 	// Atoms
 	//
 	void LlvmIrGenerator::visitTuple(ast::Tuple& t) {
-		// TODO: Needs more research on how to handle tuples
-		// May want to split this out into multiple expressions (depending on analysis work)
-		// NOTE: I can extend the llvm type system with tuples (can I?)
-		/*for (auto& elem : t.elems) {
-			auto n = visitNode(*elem);
-			builder.CreateStore(n);
-		}*/
+		// A single parenthesized expression is just that expression
+		if (t.elems.size() == 1) {
+			codegen = visitNode(*t.elems.front());
+			return;
+		}
+
+		std::vector<Value*> elems;
+		for (auto& elem : t.elems) {
+			auto value = visitNode(*elem);
+			if (!value) {
+				return;
+			}
+			elems.push_back(value);
+		}
+
+		// Elements that couldn't be typed keep the type they were generated with
+		auto type = dictionary.type_of.at(t.id).value_or(nullptr);
+		StructType* tuple_type;
+		if (type && type->kind() == +analysis::TypeKind::TUPLE) {
+			tuple_type = cast<StructType>(lowerType(type));
+		} else {
+			std::vector<Type*> elem_types;
+			for (auto* elem : elems) {
+				elem_types.push_back(elem->getType());
+			}
+			tuple_type = StructType::get(context, elem_types);
+		}
+
+		// Tuples are built as struct values, never in memory, so they stay in registers
+		// Tuples of constants fold into a constant struct (ie. for globals)
+		Value* tuple = UndefValue::get(tuple_type);
+		for (unsigned i = 0; i != elems.size(); ++i) {
+			tuple = builder.CreateInsertValue(tuple, coerce(elems[i], tuple_type->getElementType(i)), i);
+		}
+		codegen = tuple;
+	}
+	void LlvmIrGenerator::visitArray(ast::Array& a) {
+		auto type = dictionary.type_of.at(a.id).value_or(nullptr);
+		if (!type || type->kind() != +analysis::TypeKind::ARRAY) {
+			state.log(ID::err, "Unable to infer the element type of the array <at {}>", a.loc);
+			return;
+		}
+
+		auto slice_type = cast<StructType>(lowerType(type));
+		auto elem_type = lowerType(type->parts().front());
+		auto storage_type = ArrayType::get(elem_type, a.elems.size());
+		auto zero = builder.getInt64(0);
+		auto length = builder.getInt64(a.elems.size());
+
+		// Arrays of constants are the same every time they're evaluated, so they're only emitted once
+		std::vector<Constant*> constants;
+		for (auto& elem : a.elems) {
+			if (auto value = foldedConstant(*elem)) {
+				constants.push_back(cast<Constant>(coerce(value, elem_type)));
+			}
+		}
+
+		if (constants.size() == a.elems.size()) {
+			auto storage = new GlobalVariable(
+				*translation_unit, storage_type, true,
+				GlobalVariable::PrivateLinkage, ConstantArray::get(storage_type, constants), "array"
+			);
+			storage->setUnnamedAddr(GlobalValue::UnnamedAddr::Global);
+			storage->setAlignment(Align(array_alignment));
+
+			auto data = ConstantExpr::getInBoundsGetElementPtr(storage_type, storage, ArrayRef<Constant*>{ zero, zero });
+			codegen = ConstantStruct::get(slice_type, { data, length });
+			return;
+		}
+
+		// Anything else has to be initialized at runtime (see `visitAssignName` for globals)
+		if (!builder.GetInsertBlock()) {
+			return;
+		}
+
+		// Arrays that don't outlive the call are kept on the stack (see `ArrayPass`)
+		Value* data;
+		if (dictionary.local_array.at(a.id).value_or(false)) {
+			auto storage = createEntryAlloca(storage_type, "array");
+			storage->setAlignment(Align(array_alignment));
+			data = builder.CreateInBoundsGEP(storage_type, storage, { zero, zero });
+
+		// Heap arrays are freed by the caller that they're returned to (see `ownArray`)
+		// TODO: Arrays that escape in any other way are never freed, they need a more general notion of ownership
+		// NOTE: `malloc` already aligns for any builtin type
+		} else {
+			auto malloc_type = FunctionType::get(builder.getInt8PtrTy(), { builder.getInt64Ty() }, false);
+			auto size = builder.CreateAdd(ConstantExpr::getSizeOf(storage_type), builder.getInt64(array_header));
+			auto memory = builder.CreateCall(translation_unit->getOrInsertFunction("malloc", malloc_type), { size }, "array");
+			data = builder.CreateBitCast(builder.CreateInBoundsGEP(builder.getInt8Ty(), memory, builder.getInt64(array_header)), elem_type->getPointerTo());
+		}
+
+		for (size_t i = 0; i != a.elems.size(); ++i) {
+			auto value = visitNode(*a.elems[i]);
+			if (!value) {
+				return;
+			}
+			builder.CreateStore(coerce(value, elem_type), builder.CreateInBoundsGEP(elem_type, data, builder.getInt64(i)));
+		}
+
+		auto slice = builder.CreateInsertValue(UndefValue::get(slice_type), data, 0);
+		codegen = builder.CreateInsertValue(slice, length, 1);
 	}
 	void LlvmIrGenerator::visitBlock(ast::Block& b) {
 		auto parent_scope = current;
-		current = *b.locals;
+		current = *dictionary.scope_of.at(b.id);
 
 		AstVisitor::visitBlock(b);
 
 		current = parent_scope;
 	}
+	Function* LlvmIrGenerator::declareFunction(ast::Function& f) {
+		// Handle the case where the function was already "declared" earlier
+		auto fn_name = dictionary.fn_name.at(f.id)->get();
+		if (auto fn = translation_unit->getFunction(fn_name)) {
+			return fn;
+		}
+
+		// Parts of the signature that couldn't be inferred are lowered as `i32` (see `lowerType`)
+		auto type = dictionary.type_of.at(f.id).value_or(nullptr);
+		auto signature = [&](size_t part) -> const analysis::Type* {
+			if (!type || type->kind() != +analysis::TypeKind::FUNCTION || type->parts().size() != f.args.size() + 1) {
+				return nullptr;
+			}
+			return type->parts()[part];
+		};
+
+		std::vector<Type*> arg_types;
+		for (size_t i = 0; i != f.args.size(); ++i) {
+			arg_types.push_back(lowerType(signature(i)));
+		}
+
+		// `main` has to keep the signature that the c runtime expects
+		auto ret_type = fn_name == string::names::main.get() ? builder.getInt32Ty() : lowerType(signature(f.args.size()));
+		auto fn_type = FunctionType::get(ret_type, arg_types, false);
+
+		auto fn = Function::Create(fn_type, Function::ExternalLinkage, fn_name, translation_unit.get());
+
+		// Forward the function's effects (see `EffectPass`), spero has no way to unwind through known code
+		if (auto effect = dictionary.effect_of.at(f.id)) {
+			if (*effect == +analysis::Effect::PURE) {
+				fn->addFnAttr(Attribute::ReadNone);
+			} else if (*effect == +analysis::Effect::READONLY) {
+				fn->addFnAttr(Attribute::ReadOnly);
+			}
+
+			if (*effect != +analysis::Effect::UNKNOWN) {
+				fn->addFnAttr(Attribute::NoUnwind);
+			}
+		}
+
+		// TODO: This introduces bugs if the defining code, uses different names
+		// However, I feel we should already handle this during the initial language checks
+		auto old_codegen = codegen;
+		for (auto& arg : fn->args()) {
+			codegen = &arg;
+			visitArgument(*f.args[arg.getArgNo()]);
+		}
+		codegen = old_codegen;
+
+		return fn;
+	}
 	void LlvmIrGenerator::visitFunction(ast::Function& f) {
 		// TODO: How will we handle cleanup code (maybe an ast transform would handle this?)
 
@@ -76,29 +487,13 @@ namespace spero::compiler::gen {
 		// TODO: Is this what I actually want to have in spero?
 		auto old_insert_point = builder.GetInsertBlock();
 
-		// Handle the case where the function was already "declared" earlier
-		auto fn = translation_unit->getFunction(f.name->get());
-		if (!fn) {
-			// TODO: Introduce a translation from spero::Type to llvm::Type (requires spero::Type)
-			std::vector<Type*> arg_types{ f.args.size(), Type::getInt32Ty(context) };
-			auto fn_type = FunctionType::get(Type::getInt32Ty(context), arg_types, false);
-
-			fn = Function::Create(fn_type, Function::ExternalLinkage, f.name->get(), translation_unit.get());
-
-			// TODO: This introduces bugs if the defining code, uses different names
-			// However, I feel we should already handle this during the initial language checks
-			auto old_codegen = codegen;
-			for (auto& arg : fn->args()) {
-				codegen = &arg;
-				visitArgument(*f.args[arg.getArgNo()]);
-			}
-			codegen = old_codegen;
-		}
+		auto fn = declareFunction(f);
 
 		if (!fn->empty()) {
-			state.log(ID::err, "Function {} already has llvm definition <at {}>", f.name->get(), f.loc);
+			state.log(ID::err, "Function {} already has llvm definition <at {}>", fn->getName().str(), f.loc);
 			return;
 		}
+		auto outer_owned = std::exchange(owned_arrays, nullptr);
 
 		// Create the basic blocks
 		auto entry_block = BasicBlock::Create(context, "entry", fn);
@@ -110,14 +505,30 @@ namespace spero::compiler::gen {
 		// TODO: Map function argument to symbol table
 		if (auto retval = visitNode(*f.body)) {
 			// TODO: Codegen cleanup code (this'll probably be pushed into the block)
-			builder.CreateRet(retval);
-			codegen = fn;
+			builder.CreateRet(coerce(retval, fn->getReturnType()));
+
+		} else if (isUnreachable(builder.GetInsertBlock())) {
+			// Every path through the body already returned
+			builder.CreateUnreachable();
 
 		} else {
-			fn->eraseFromParent();
-			codegen = nullptr;
+			// The function was declared upfront, so it can't be erased as earlier functions may already call it
+			state.log(ID::err, "Function {} doesn't produce a value <at {}>", fn->getName().str(), f.loc);
+			builder.CreateRet(Constant::getNullValue(fn->getReturnType()));
 		}
 
+		// The arrays that the function owns are freed on every path out of it
+		// NOTE: Returned values are computed first, but they're never owned by the function that returns them
+		if (owned_arrays) {
+			for (auto& block : *fn) {
+				if (auto* ret = dyn_cast_or_null<ReturnInst>(block.getTerminator())) {
+					IRBuilder<>{ ret }.CreateCall(releaseArrays(*translation_unit), { owned_arrays });
+				}
+			}
+		}
+		owned_arrays = outer_owned;
+		codegen = fn;
+
 		// Restore the old insertion point
 		builder.SetInsertPoint(old_insert_point);
 	}
@@ -126,18 +537,27 @@ namespace spero::compiler::gen {
 	// Names
 	//
 	void LlvmIrGenerator::visitVariable(ast::Variable& v) {
+		if (auto value = foldedConstant(v)) {
+			codegen = value;
+			return;
+		}
+
 		// TODO: Reduce the variable access at this stage to a flat map lookup
 		auto& path_part = v.name->elems.back();
-		auto nvar = arena[*v.def_table].get(path_part->name, nullptr, path_part->loc, path_part->ssa_index);
-
-		auto& symbol = std::get<ref_t<analysis::SymbolInfo>>(*nvar);
-		if (symbol.get().storage) {
-			auto storage = symbol.get().storage;
-			if (!isa<Argument>(storage)) {
-				codegen = builder.CreateLoad(storage);
-			} else {
-				codegen = storage;
+		auto nvar = arena[*dictionary.def_table.at(v.id)].get(path_part->name, nullptr, dictionary.ssa_index[path_part->id]);
+
+		// Immutable locals and arguments are bound directly to their ssa value, anything else is loaded from its slot
+		auto& symbol = std::get<ref_t<analysis::SymbolInfo>>(*nvar).get();
+		if (auto storage = symbol.storage) {
+			// Outside of a function (ie. in a global's initializer) only the value of a constant global is known
+			// NOTE: Globals whose definition was already freed (ie. when streaming) can't be folded, so they reach this
+			if (symbol.slot_type && !builder.GetInsertBlock()) {
+				auto* global = dyn_cast<GlobalVariable>(storage);
+				codegen = global && global->isConstant() ? global->getInitializer() : nullptr;
+				return;
 			}
+
+			codegen = symbol.slot_type ? builder.CreateLoad(symbol.slot_type, storage) : storage;
 		}
 	}
 	void LlvmIrGenerator::visitAssignName(ast::AssignName& a) {
@@ -145,25 +565,51 @@ namespace spero::compiler::gen {
 			// TODO: By this stage we should probably reduce the scope tables to a flatter map
 			// And not require the usage of "generic" type value information
 			// This would also "validate" the assumptions we make about the symbol existing
-			opt_t<size_t> ssa_index = std::nullopt;
-			auto nvar = arena[current].get(a.var->name, nullptr, a.var->loc, ssa_index);
+			auto ssa_index = dictionary.ssa_index.at(a.id);
+			auto nvar = arena[current].get(a.var->name, nullptr, ssa_index);
 
 			// We can assume that the symbol exists if we get to this point (VarDeclPass would automatically insert it)
 			auto& symbol = std::get<ref_t<analysis::SymbolInfo>>(*nvar).get();
 			switch (arena[current].context()) {
 				case analysis::ScopingContext::GLOBAL: {
-					auto initializer = dyn_cast<Constant>(codegen);
+					// Constant expressions have already been folded, so anything else would need to run at program start
+					auto initializer = dyn_cast_or_null<Constant>(codegen);
+					if (!initializer) {
+						state.log(ID::err, "Global `{}` must be initialized with a compile-time constant <at {}>", a.var->name, a.loc);
+						break;
+					}
+
+					// Casting a constant folds it, so the initializer stays constant
+					auto type = symbol.type ? lowerType(symbol.type) : initializer->getType();
+					initializer = cast<Constant>(coerce(initializer, type));
+
 					auto storage = new GlobalVariable(
-						*translation_unit, Type::getInt32Ty(context), a.is_mut,
+						*translation_unit, type, !a.is_mut,
 						GlobalVariable::ExternalLinkage, initializer, a.var->name.get()
 					);
-					// TODO: What do I do if the "initializer" isn't considered to be constant?
 					symbol.storage = storage;
-					//break;
+					symbol.slot_type = type;
+					break;
 				}
 				case analysis::ScopingContext::SCOPE: {
-					auto storage = builder.CreateAlloca(Type::getInt32Ty(context), nullptr, a.var->name.get());
-					codegen = builder.CreateStore(codegen, symbol.storage = storage);
+					if (!codegen) {
+						break;
+					}
+
+					// Immutable bindings never change, so they can just refer to the value directly
+					if (!symbol.is_mut) {
+						if (isa<Instruction>(codegen) && !codegen->hasName()) {
+							codegen->setName(a.var->name.get());
+						}
+						symbol.storage = codegen;
+						symbol.slot_type = nullptr;
+						break;
+					}
+
+					auto type = symbol.type ? lowerType(symbol.type) : codegen->getType();
+					auto storage = createEntryAlloca(type, a.var->name.get());
+					codegen = builder.CreateStore(coerce(codegen, type), symbol.storage = storage);
+					symbol.slot_type = type;
 					break;
 				}
 				case analysis::ScopingContext::TYPE:
@@ -178,6 +624,37 @@ namespace spero::compiler::gen {
 		}
 	}
 
+	void LlvmIrGenerator::visitAssignTuple(ast::AssignTuple& a) {
+		// `(a)` is just a parenthesized name
+		if (a.elems.size() == 1) {
+			a.elems.front()->accept(*this);
+			return;
+		}
+
+		auto tuple = codegen;
+		if (!tuple) {
+			return;
+		}
+
+		auto tuple_type = dyn_cast<StructType>(tuple->getType());
+		if (!tuple_type || tuple_type->getNumElements() != a.elems.size()) {
+			state.log(ID::err, "Unable to destructure the value into {} elements <at {}>", a.elems.size(), a.loc);
+			return;
+		}
+
+		// Every element is bound to its own value, so the tuple is never stored just to be taken apart
+		for (unsigned i = 0; i != a.elems.size(); ++i) {
+			// `_` doesn't bind anything
+			if (!dynamic_cast<ast::AssignName*>(a.elems[i].get()) && !dynamic_cast<ast::AssignTuple*>(a.elems[i].get())) {
+				continue;
+			}
+
+			codegen = builder.CreateExtractValue(tuple, i);
+			a.elems[i]->accept(*this);
+		}
+		codegen = tuple;
+	}
+
 	//
 	// Decorations
 	//
@@ -187,11 +664,13 @@ namespace spero::compiler::gen {
 		if (auto arg = dyn_cast_or_null<Argument>(codegen)) {
 			arg->setName(a.name->name.get());
 
-			opt_t<size_t> ssa_index = std::nullopt;
-			auto nvar = arena[current].get(a.name->name, nullptr, a.loc, ssa_index);
+			auto ssa_index = dictionary.ssa_index.at(a.id);
+			auto nvar = arena[current].get(a.name->name, nullptr, ssa_index);
 
 			// We can assume that the symbol exists if we get to this point (VarDeclPass would automatically insert it)
-			std::get<ref_t<analysis::SymbolInfo>>(*nvar).get().storage = arg;
+			auto& symbol = std::get<ref_t<analysis::SymbolInfo>>(*nvar).get();
+			symbol.storage = arg;
+			symbol.slot_type = nullptr;
 
 		} else {
 			state.log(ID::err, "Attempt to visit arg {} with a non llvm::Argument* previous value <at {}>", a.name->name, a.loc);
@@ -201,6 +680,127 @@ namespace spero::compiler::gen {
 	//
 	// Control
 	//
+	void LlvmIrGenerator::continueAfterJump() {
+		builder.SetInsertPoint(BasicBlock::Create(context, "after.jump", builder.GetInsertBlock()->getParent()));
+		codegen = nullptr;
+	}
+	bool LlvmIrGenerator::isUnreachable(BasicBlock* block) {
+		return block != &block->getParent()->getEntryBlock() && block->hasNPredecessors(0);
+	}
+	void LlvmIrGenerator::ownArray(Value* array) {
+		auto bytes_type = builder.getInt8PtrTy();
+		if (!owned_arrays) {
+			owned_arrays = createEntryAlloca(bytes_type, "owned");
+			IRBuilder<> entry_builder{ owned_arrays->getNextNode() };
+			entry_builder.CreateStore(ConstantPointerNull::get(bytes_type), owned_arrays);
+		}
+
+		auto data = builder.CreateBitCast(builder.CreateExtractValue(array, 0), bytes_type);
+		auto header = builder.CreateInBoundsGEP(builder.getInt8Ty(), data, builder.getInt64(-array_header));
+		builder.CreateStore(builder.CreateLoad(bytes_type, owned_arrays), builder.CreateBitCast(header, bytes_type->getPointerTo()));
+		builder.CreateStore(header, owned_arrays);
+	}
+	void LlvmIrGenerator::generateLoop(ast::Loop& l, ast::ValExpr* test) {
+		auto curr_fn = builder.GetInsertBlock()->getParent();
+		auto header = BasicBlock::Create(context, "loop.header", curr_fn);
+		auto body = BasicBlock::Create(context, "loop.body", curr_fn);
+		auto latch = BasicBlock::Create(context, "loop.latch", curr_fn);
+		auto exit = BasicBlock::Create(context, "loop.exit", curr_fn);
+
+		// The current block only falls into the loop, so it already is a preheader
+		builder.CreateBr(header);
+
+		builder.SetInsertPoint(header);
+		if (!test) {
+			builder.CreateBr(body);
+		} else if (auto cond = visitNode(*test)) {
+			builder.CreateCondBr(truthValue(cond), body, exit);
+		} else {
+			builder.CreateBr(exit);
+		}
+
+		builder.SetInsertPoint(body);
+		loops.emplace_back(latch, exit);
+		visitNode(*l.body);
+		loops.pop_back();
+		builder.CreateBr(latch);
+
+		// Every iteration (including `continue`) goes through the latch, so it has the only backedge
+		builder.SetInsertPoint(latch);
+		auto backedge = builder.CreateBr(header);
+		if (auto loop_id = loopMetadata(l)) {
+			backedge->setMetadata(LLVMContext::MD_loop, loop_id);
+		}
+
+		// Loops don't produce a value, so they evaluate to unit (see `coerce`)
+		builder.SetInsertPoint(exit);
+		codegen = Constant::getNullValue(StructType::get(context));
+	}
+	void LlvmIrGenerator::visitLoop(ast::Loop& l) {
+		generateLoop(l, nullptr);
+	}
+	void LlvmIrGenerator::visitWhile(ast::While& w) {
+		generateLoop(w, w.test.get());
+	}
+	void LlvmIrGenerator::visitFor(ast::For& f) {
+		auto array = visitNode(*f.generator);
+		auto type = dictionary.type_of.at(f.generator->id).value_or(nullptr);
+		if (!array || !type || type->kind() != +analysis::TypeKind::ARRAY) {
+			state.log(ID::err, "For loops can only iterate over arrays <at {}>", f.generator->loc);
+			return;
+		}
+
+		auto elem_type = lowerType(type->parts().front());
+		auto data = builder.CreateExtractValue(array, 0, "for.data");
+		auto length = builder.CreateExtractValue(array, 1, "for.length");
+
+		auto preheader = builder.GetInsertBlock();
+		auto curr_fn = preheader->getParent();
+		auto header = BasicBlock::Create(context, "for.header", curr_fn);
+		auto body = BasicBlock::Create(context, "for.body", curr_fn);
+		auto latch = BasicBlock::Create(context, "for.latch", curr_fn);
+		auto exit = BasicBlock::Create(context, "for.exit", curr_fn);
+		builder.CreateBr(header);
+
+		// The index counts from 0 up to the length, so every element access is in bounds without a check
+		builder.SetInsertPoint(header);
+		auto index = builder.CreatePHI(builder.getInt64Ty(), 2, "for.index");
+		index->addIncoming(builder.getInt64(0), preheader);
+		builder.CreateCondBr(builder.CreateICmpULT(index, length), body, exit);
+
+		builder.SetInsertPoint(body);
+		auto parent_scope = current;
+		current = *dictionary.scope_of.at(f.id);
+
+		// The element is an immutable binding, so it's bound directly to its ssa value
+		if (auto* var = dynamic_cast<ast::VarPattern*>(f.pattern.get())) {
+			auto& name = var->name->elems.back()->name;
+			auto nvar = arena[current].get(name, nullptr, dictionary.ssa_index[var->id]);
+
+			auto elem = builder.CreateLoad(elem_type, builder.CreateInBoundsGEP(elem_type, data, index), name.get());
+			auto& symbol = std::get<ref_t<analysis::SymbolInfo>>(*nvar).get();
+			symbol.storage = elem;
+			symbol.slot_type = nullptr;
+		}
+
+		loops.emplace_back(latch, exit);
+		visitNode(*f.body);
+		loops.pop_back();
+		builder.CreateBr(latch);
+
+		current = parent_scope;
+
+		// `index < length` holds in the body, so the increment can't wrap
+		builder.SetInsertPoint(latch);
+		index->addIncoming(builder.CreateAdd(index, builder.getInt64(1), "for.next", true, true), latch);
+		auto backedge = builder.CreateBr(header);
+		if (auto loop_id = loopMetadata(f)) {
+			backedge->setMetadata(LLVMContext::MD_loop, loop_id);
+		}
+
+		builder.SetInsertPoint(exit);
+		codegen = Constant::getNullValue(StructType::get(context));
+	}
 	void LlvmIrGenerator::visitIfBranch(ast::IfBranch& b) {
 		// TODO: This holds the structures for a conditional block
 		// I don't think this is enough to generate code for llvm
@@ -211,59 +811,132 @@ namespace spero::compiler::gen {
 		// I think this is where any if handling will have to be situated
 		// We might be required to translate all raw `IfBranch` nodes into an `IfElse` node
 
+		// A branch that just produces a constant doesn't need any code of its own
+		auto constantBody = [&](ast::ValExpr& body) -> Constant* {
+			if (auto* block = dynamic_cast<ast::Block*>(&body); block && block->elems.size() == 1) {
+				auto* expr = dynamic_cast<ast::ValExpr*>(block->elems.front().get());
+				return expr ? foldedConstant(*expr) : nullptr;
+			}
+			return foldedConstant(body);
+		};
+
+		// So choosing between two constants is just a select (the test is evaluated exactly once either way)
+		if (e.elems.size() == 1 && e.else_) {
+			auto then_value = constantBody(*e.elems.front()->body);
+			auto else_value = constantBody(*e.else_);
+
+			if (then_value && else_value && then_value->getType() == else_value->getType()) {
+				auto test = truthValue(visitNode(*e.elems.front()->test));
+				codegen = builder.CreateSelect(test, then_value, else_value);
+				return;
+			}
+		}
+
 		// TODO: The Kaleidoscope tutorial explicitly adds all of the basic blocks to the function's BB list. Why?
 		auto curr_fn = builder.GetInsertBlock()->getParent();
-
 		auto merge_point = BasicBlock::Create(context, "merge", curr_fn);
-		std::vector<BasicBlock*> bbs;
 
-		// Create the location to save the branch value
-		// NOTE: We only create a value if there is an else branch
-		// TODO: Only create this value if some code utilizes the value of the branch???s
-		AllocaInst* branch_value_storage = nullptr;
-		if (e.else_) {
-			branch_value_storage = builder.CreateAlloca(Type::getInt32Ty(context));
-		}
+		// The value of each branch along with the block that it flows into `merge_point` from
+		// NOTE: The if only has a value if there is an else branch (and every branch produces one)
+		std::vector<std::pair<Value*, BasicBlock*>> incoming;
+		auto generateBody = [&](ast::ValExpr& body) {
+			auto value = visitNode(body);
+
+			// A branch that left through a jump (ie. `return`) never reaches `merge_point`
+			if (!value && isUnreachable(builder.GetInsertBlock())) {
+				builder.CreateUnreachable();
+				return;
+			}
+
+			incoming.emplace_back(value, builder.GetInsertBlock());
+			builder.CreateBr(merge_point);
+		};
 
-		// TODO: How do I handle if branches with no else (for the purpose of the value)
 		// TODO: I want to push this portion into the `visitIfBranch` code but it doesn't type right now
-		// We would need to be able to pass in `merge_point` and `branch_value_storage` (set as member?)
-		// It would also be possible to run `setInsertPoint; CreateBr; setInsertPoint` afterwards (with a lot of work)
+		// We would need to be able to pass in `merge_point` and `incoming` (set as member?)
+		// NOTE: `@likely`/`@unlikely` only apply to the first test
+		auto weights = expectedWeights(e);
 		for (auto& branch : e.elems) {
 			auto then_block = BasicBlock::Create(context, "then", curr_fn);
 			auto else_block = BasicBlock::Create(context, "else", curr_fn);
-			builder.CreateCondBr(visitNode(*branch->test), then_block, else_block);
-			
-			// Visit the conditional's body, storing the body's value on the stack
-			builder.SetInsertPoint(then_block);
-			if (branch_value_storage) {
-				// TODO: Should the storage be volatile or not
-				builder.CreateStore(visitNode(*branch->body), branch_value_storage, false);
-			}
-			builder.CreateBr(merge_point);
+			builder.CreateCondBr(truthValue(visitNode(*branch->test)), then_block, else_block, std::exchange(weights, nullptr));
 
-			bbs.push_back(builder.GetInsertBlock());
+			builder.SetInsertPoint(then_block);
+			generateBody(*branch->body);
 			builder.SetInsertPoint(else_block);
 		}
 
 		// Codegen the else branch in the leftover basic block from the if series
+		// NOTE: The last `BasicBlock` of the if series will be empty if there is no else statement (OK?)
 		if (e.else_) {
-			builder.CreateStore(visitNode(*e.else_), branch_value_storage);
+			generateBody(*e.else_);
+		} else {
 			builder.CreateBr(merge_point);
 		}
-
-		// Create the next block
-		// NOTE: The last `BasicBlock` of the if series will be empty if there is no else statement (OK?)
-		builder.CreateBr(merge_point);
 		builder.SetInsertPoint(merge_point);
 
-		// TODO: Create all the phi nodes
-		// TODO: Figure out whether I need phi nodes (variables are just pushed on the stack)
-		
-		// Load the value of the executed branch for future use
-		if (branch_value_storage) {
-			codegen = builder.CreateLoad(branch_value_storage);
+		if (!e.else_ || incoming.empty()) {
+			return;
+		}
+
+		// Merge the branch values with a phi, instead of passing them through the stack
+		for (auto&[value, block] : incoming) {
+			if (!value) {
+				return;
+			}
+		}
+
+		auto phi_type = dictionary.type_of.at(e.id) ? lowerTypeOf(e) : incoming.front().first->getType();
+		auto phi = builder.CreatePHI(phi_type, incoming.size());
+		for (auto&[value, block] : incoming) {
+			// Any conversion has to happen before the branch into `merge_point`
+			IRBuilderBase::InsertPointGuard guard{ builder };
+			builder.SetInsertPoint(block->getTerminator());
+			phi->addIncoming(coerce(value, phi_type), block);
+		}
+		codegen = phi;
+	}
+
+	void LlvmIrGenerator::visitJump(ast::Jump& j) {
+		// TODO: `yield` and `wait` need coroutines
+		if (j.type == +ast::KeywordType::YIELD || j.type == +ast::KeywordType::WAIT) {
+			state.log(ID::err, "`{}` isn't supported yet <at {}>", j.type == +ast::KeywordType::YIELD ? "yield" : "wait", j.loc);
+			return;
+		}
+
+		if (j.type == +ast::KeywordType::RET) {
+			if (!builder.GetInsertBlock()) {
+				state.log(ID::err, "`return` can only be used inside of a function <at {}>", j.loc);
+				return;
+			}
+
+			// A bare `return` returns unit (see `coerce`)
+			auto value = j.expr ? visitNode(*j.expr) : Constant::getNullValue(StructType::get(context));
+			if (!value) {
+				state.log(ID::err, "`return` needs a value <at {}>", j.loc);
+				return;
+			}
+
+			builder.CreateRet(coerce(value, builder.GetInsertBlock()->getParent()->getReturnType()));
+			continueAfterJump();
+			return;
+		}
+
+		auto is_break = j.type == +ast::KeywordType::BREAK;
+
+		if (loops.empty()) {
+			state.log(ID::err, "`{}` can only be used inside of a loop <at {}>", is_break ? "break" : "continue", j.loc);
+			return;
+		}
+
+		// Loops don't produce a value, so the value is only evaluated for its effects
+		if (j.expr) {
+			visitNode(*j.expr);
 		}
+
+		auto[continue_target, break_target] = loops.back();
+		builder.CreateBr(is_break ? break_target : continue_target);
+		continueAfterJump();
 	}
 
 	//
@@ -280,7 +953,7 @@ namespace spero::compiler::gen {
 	//
 	void LlvmIrGenerator::visitInAssign(ast::InAssign& in) {
 		auto parent_scope = current;
-		current = *in.binding;
+		current = *dictionary.scope_of.at(in.id);
 
 		visitVarAssign(*in.bind);
 		in.expr->accept(*this);
@@ -288,94 +961,182 @@ namespace spero::compiler::gen {
 		current = parent_scope;
 	}
 	void LlvmIrGenerator::visitBinOpCall(ast::BinOpCall& b) {
-		if (b.op == "=") {
+		if (b.op == string::names::assign) {
 			auto rhs = visitNode(*b.rhs);
 
 			// TODO: Rewrite with a flat symbol table
 			auto lhs = dynamic_cast<ast::Variable*>(b.lhs.get());
 			auto& path_part = lhs->name->elems.back();
-			auto variable = arena[*lhs->def_table].get(path_part->name, nullptr, path_part->loc, path_part->ssa_index);
+			auto variable = arena[*dictionary.def_table.at(lhs->id)].get(path_part->name, nullptr, dictionary.ssa_index[path_part->id]);
 
 			auto& var = std::get<ref_t<analysis::SymbolInfo>>(*variable).get();
-			if (var.storage) {
-				codegen = builder.CreateStore(rhs, var.storage);
+			// The value of an assignment is the assigned value
+			if (var.storage && var.slot_type && rhs) {
+				codegen = coerce(rhs, var.slot_type);
+				builder.CreateStore(codegen, var.storage);
 			}
 
 			return;
 		}
 
-		auto lhs = visitNode(*b.lhs);
-		auto rhs = visitNode(*b.rhs);
-
-		// Ensure the llvm values have the same types
-		// TODO: Come up with a better system for this
-		auto int32_type = Type::getInt32Ty(context);
-		if (lhs->getType() != int32_type) {
-			lhs = builder.CreateIntCast(lhs, int32_type, true);
-		}
-		if (rhs->getType() != int32_type) {
-			rhs = builder.CreateIntCast(rhs, int32_type, true);
+		if (auto value = foldedConstant(b)) {
+			codegen = value;
+			return;
 		}
 
-		if (b.op == "+") {
-			codegen = builder.CreateAdd(lhs, rhs);
+		// `&&` and `||` only evaluate their right side if the left side doesn't decide the result
+		if (b.op == "&&" || b.op == "||") {
+			auto is_and = b.op == "&&";
+			auto lhs = visitNode(*b.lhs);
+			if (!lhs) {
+				return;
+			}
+			lhs = truthValue(lhs);
 
-		} else if (b.op == "-") {
-			codegen = builder.CreateSub(lhs, rhs);
+			// Evaluating a cheap right side unconditionally is faster than branching around it
+			if (isCheapAndPure(*b.rhs, dictionary)) {
+				if (auto rhs = visitNode(*b.rhs)) {
+					rhs = truthValue(rhs);
+					codegen = is_and ? builder.CreateSelect(lhs, rhs, builder.getFalse()) : builder.CreateSelect(lhs, builder.getTrue(), rhs);
+				}
+				return;
+			}
 
-		} else if (b.op == "*") {
-			codegen = builder.CreateMul(lhs, rhs);
+			auto curr_fn = builder.GetInsertBlock()->getParent();
+			auto lhs_block = builder.GetInsertBlock();
+			auto rhs_block = BasicBlock::Create(context, is_and ? "and.rhs" : "or.rhs", curr_fn);
+			auto merge_point = BasicBlock::Create(context, is_and ? "and.merge" : "or.merge", curr_fn);
 
-		} else if (b.op == "/") {
-			// I'm assuming this means "create signed division"
-			codegen = builder.CreateSDiv(lhs, rhs);
+			// The weights say whether the whole expression is expected to be true, and so whether the left side is
+			auto weights = expectedWeights(b);
+			if (is_and) {
+				builder.CreateCondBr(lhs, rhs_block, merge_point, weights);
+			} else {
+				builder.CreateCondBr(lhs, merge_point, rhs_block, weights);
+			}
 
-		} else if (b.op == "%") {
-			codegen = builder.CreateSRem(lhs, rhs);
+			builder.SetInsertPoint(rhs_block);
+			auto rhs = visitNode(*b.rhs);
+			if (!rhs) {
+				return;
+			}
+			rhs = truthValue(rhs);
+			rhs_block = builder.GetInsertBlock();
+			builder.CreateBr(merge_point);
+
+			builder.SetInsertPoint(merge_point);
+			auto phi = builder.CreatePHI(builder.getInt1Ty(), 2);
+			phi->addIncoming(builder.getInt1(!is_and), lhs_block);
+			phi->addIncoming(rhs, rhs_block);
+			codegen = phi;
+			return;
+		}
+
+		auto lhs = visitNode(*b.lhs);
+		auto rhs = visitNode(*b.rhs);
+		if (!lhs || !rhs) {
+			return;
+		}
 
-		} else if (b.op == "==") {
-			codegen = builder.CreateICmpEQ(lhs, rhs);
+		// Typing has already given both sides the same type, so this only matters for values that couldn't be typed
+		auto operand_type = lhs->getType();
+		auto rhs_type = rhs->getType();
+		if (rhs_type->isFloatingPointTy() || (operand_type->isIntegerTy() && rhs_type->isIntegerTy() && rhs_type->getIntegerBitWidth() > operand_type->getIntegerBitWidth())) {
+			operand_type = rhs_type;
+		}
+		lhs = coerce(lhs, operand_type);
+		rhs = coerce(rhs, operand_type);
 
-		} else if (b.op == "!=") {
-			codegen = builder.CreateICmpNE(lhs, rhs);
+		// `Byte` is the only unsigned type
+		auto lhs_type = dictionary.type_of.at(b.lhs->id).value_or(nullptr);
+		auto is_float = operand_type->isFloatingPointTy();
+		auto is_unsigned = lhs_type && lhs_type->name() == string::names::Byte;
 
-		} else if (b.op == "<") {
-			codegen = builder.CreateICmpSLT(lhs, rhs);
+		if (b.op == "+") {
+			codegen = is_float ? builder.CreateFAdd(lhs, rhs) : builder.CreateAdd(lhs, rhs);
 
-		} else if (b.op == "<=") {
-			codegen = builder.CreateICmpSLE(lhs, rhs);
+		} else if (b.op == "-") {
+			codegen = is_float ? builder.CreateFSub(lhs, rhs) : builder.CreateSub(lhs, rhs);
 
-		} else if (b.op == ">") {
-			codegen = builder.CreateICmpSGT(lhs, rhs);
+		} else if (b.op == "*") {
+			codegen = is_float ? builder.CreateFMul(lhs, rhs) : builder.CreateMul(lhs, rhs);
 
-		} else if (b.op == ">=") {
-			codegen = builder.CreateICmpSGE(lhs, rhs);
+		} else if (b.op == "/") {
+			codegen = is_float ? builder.CreateFDiv(lhs, rhs) : is_unsigned ? builder.CreateUDiv(lhs, rhs) : builder.CreateSDiv(lhs, rhs);
 
 		} else if (b.op == "%") {
-			// TODO: How to represent modulo in llvm ir?
-
-		} else if (b.op == "&&") {
-			// TODO: Does llvm implement lazy eval for &&/||
-			codegen = builder.CreateAnd(lhs, rhs);
+			codegen = is_float ? builder.CreateFRem(lhs, rhs) : is_unsigned ? builder.CreateURem(lhs, rhs) : builder.CreateSRem(lhs, rhs);
 
-		} else if (b.op == "||") {
-			// TODO: Does llvm implement lazy eval for &&/||
-			codegen = builder.CreateOr(lhs, rhs);
+		} else if (auto predicate = comparisonPredicate(b.op, is_float, is_unsigned)) {
+			codegen = is_float ? builder.CreateFCmp(*predicate, lhs, rhs) : builder.CreateICmp(*predicate, lhs, rhs);
 		}
 	}
 	void LlvmIrGenerator::visitUnOpCall(ast::UnOpCall& u) {
+		if (auto value = foldedConstant(u)) {
+			codegen = value;
+			return;
+		}
+
 		auto expr = visitNode(*u.expr);
+		if (!expr) {
+			return;
+		}
 
 		if (auto& op = u.op->name; op == "-") {
-			codegen = builder.CreateNeg(expr);
+			codegen = expr->getType()->isFloatingPointTy() ? builder.CreateFNeg(expr) : builder.CreateNeg(expr);
 
 		} else if (op == "!") {
-			// TODO: Implement this correctly (but how?)
-			//auto comp_val = builder.CreateICmp(ICmpInst::ICMP_SGT, expr, Zero)
-			codegen = builder.CreateNot(expr);
+			codegen = builder.CreateNot(truthValue(expr));
 		}
 	}
+	void LlvmIrGenerator::visitIndex(ast::Index& i) {
+		auto value = visitNode(*i.elems.front());
+		auto type = dictionary.type_of.at(i.elems.front()->id).value_or(nullptr);
+
+		for (auto iter = std::next(i.elems.begin()); iter != i.elems.end() && value; ++iter) {
+			auto& index_expr = **iter;
+			if (!type || type->kind() != +analysis::TypeKind::ARRAY) {
+				state.log(ID::err, "Only arrays can be indexed <at {}>", index_expr.loc);
+				return;
+			}
+
+			auto index = visitNode(index_expr);
+			if (!index) {
+				return;
+			}
+			index = coerce(index, builder.getInt64Ty());
+
+			// Negative indices are huge when compared as unsigned, so a single comparison checks both bounds
+			if (!dictionary.in_bounds.at(index_expr.id).value_or(false)) {
+				auto curr_fn = builder.GetInsertBlock()->getParent();
+				auto fail_block = BasicBlock::Create(context, "bounds.fail", curr_fn);
+				auto ok_block = BasicBlock::Create(context, "bounds.ok", curr_fn);
+
+				auto length = builder.CreateExtractValue(value, 1);
+				auto weights = MDBuilder{ context }.createBranchWeights(likely_weight, unlikely_weight);
+				builder.CreateCondBr(builder.CreateICmpULT(index, length), ok_block, fail_block, weights);
+
+				// TODO: Report out of bounds accesses once spero has some form of error handling
+				builder.SetInsertPoint(fail_block);
+				builder.CreateIntrinsic(Intrinsic::trap, {}, {});
+				builder.CreateUnreachable();
+				builder.SetInsertPoint(ok_block);
+			}
+
+			type = type->parts().front();
+			auto elem_type = lowerType(type);
+			auto address = builder.CreateInBoundsGEP(elem_type, builder.CreateExtractValue(value, 0), index);
+			value = builder.CreateLoad(elem_type, address);
+		}
+
+		codegen = value;
+	}
 	void LlvmIrGenerator::visitFnCall(ast::FnCall& f) {
+		if (auto value = foldedConstant(f)) {
+			codegen = value;
+			return;
+		}
+
 		auto fn_name = util::viewAs<ast::Variable>(f.callee);
 		if (!fn_name) {
 			state.log(compiler::ID::err, "Calling non-var-bound functions is currently not supported <at {}>", f.loc);
@@ -400,11 +1161,20 @@ namespace spero::compiler::gen {
 		// TODO: How do I handle "self" arguments (for OOP) when they are needed?
 		std::vector<Value*> args;
 		for (auto& arg : f.arguments->elems) {
-			args.push_back(visitNode(*arg));
+			auto value = visitNode(*arg);
+			if (!value) {
+				return;
+			}
+			args.push_back(coerce(value, fn->getFunctionType()->getParamType(args.size())));
 		}
 
 		// And create the call instruction
 		codegen = builder.CreateCall(fn, args);
+
+		// The caller takes ownership of a heap array that the callee created for it (see `ArrayPass`)
+		if (dictionary.owned_result.at(f.id).value_or(false) && codegen->getType()->isStructTy()) {
+			ownArray(codegen);
+		}
 	}
 
 }
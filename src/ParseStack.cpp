@@ -0,0 +1,136 @@
+#include "parser/ParseStack.h"
+
+namespace spero::parser {
+
+	using namespace compiler;
+
+	void ParseStack::pushSymbol(char ch, Location loc) {
+		frames.push_back(entries.size());
+		entries.emplace_back(Symbol{ ch, std::move(loc) });
+	}
+	void ParseStack::pushSentinel(Location loc) {
+		entries.emplace_back(Sentinel{ std::move(loc) });
+	}
+
+	void ParseStack::openFrame(Location loc) {
+		if (entries.empty()) {
+			frames.push_back(0);
+			entries.emplace_back(Sentinel{ std::move(loc) });
+			return;
+		}
+
+		auto top = std::move(entries.back());
+		entries.pop_back();
+
+		// The top entry may itself open a frame, which has to be nested within the new one
+		bool top_opens_frame = !frames.empty() && frames.back() == entries.size();
+		if (top_opens_frame) {
+			frames.pop_back();
+		}
+
+		frames.push_back(entries.size());
+		entries.emplace_back(Sentinel{ std::move(loc) });
+
+		if (top_opens_frame) {
+			frames.push_back(entries.size());
+		}
+		entries.push_back(std::move(top));
+	}
+
+	const Location& ParseStack::loc(size_t depth) const {
+		auto& entry = entries[entries.size() - depth - 1];
+
+		return std::visit([](auto& val) -> const Location& {
+			if constexpr (std::is_same_v<std::decay_t<decltype(val)>, ptr<ast::Ast>>) {
+				return val->loc;
+			} else {
+				return val.loc;
+			}
+		}, entry);
+	}
+
+	opt_t<ParseStack::Token> ParseStack::popToken() {
+		if (entries.empty() || !std::holds_alternative<Token>(entries.back())) {
+			return std::nullopt;
+		}
+
+		auto ret = std::move(std::get<Token>(entries.back()));
+		pop_back();
+		return std::move(ret);
+	}
+	opt_t<ParseStack::Symbol> ParseStack::popSymbol() {
+		if (entries.empty() || !std::holds_alternative<Symbol>(entries.back())) {
+			return std::nullopt;
+		}
+
+		auto ret = std::move(std::get<Symbol>(entries.back()));
+		pop_back();
+		return std::move(ret);
+	}
+	void ParseStack::pop_back() {
+		entries.pop_back();
+
+		if (!frames.empty() && frames.back() == entries.size()) {
+			frames.pop_back();
+		}
+	}
+
+	opt_t<ParseStack::Symbol> ParseStack::closeFrame() {
+		if (frames.empty()) {
+			return std::nullopt;
+		}
+
+		auto start = entries.begin() + frames.back();
+		frames.pop_back();
+
+		opt_t<Symbol> ret = std::nullopt;
+		if (auto* sym = std::get_if<Symbol>(&*start)) {
+			ret = std::move(*sym);
+		}
+
+		entries.erase(start);
+		return std::move(ret);
+	}
+
+	template<class Fn>
+	static void materialize(std::vector<ParseStack::Entry>& entries, Fn&& consumer) {
+		for (auto& entry : entries) {
+			std::visit([&](auto& val) {
+				using T = std::decay_t<decltype(val)>;
+
+				if constexpr (std::is_same_v<T, ptr<ast::Ast>>) {
+					consumer(std::move(val));
+
+				} else if constexpr (std::is_same_v<T, ParseStack::Token>) {
+					std::visit([&](auto tkn) {
+						consumer(std::make_unique<ast::Token>(tkn, val.loc));
+					}, val.value);
+
+				} else if constexpr (std::is_same_v<T, ParseStack::Symbol>) {
+					consumer(std::make_unique<ast::Symbol>(val.ch, val.loc));
+
+				} else {
+					consumer(nullptr);
+				}
+			}, entry);
+		}
+
+		entries.clear();
+	}
+
+	void ParseStack::moveNodesInto(Stack& ast) {
+		materialize(entries, [&](ptr<ast::Ast> node) { ast.push_back(std::move(node)); });
+		frames.clear();
+	}
+
+	void ParseStack::streamTo(std::function<void(ptr<ast::Ast>)> consumer) {
+		sink = std::move(consumer);
+	}
+	void ParseStack::flush() {
+		// Only complete top-level entries can be handed off
+		if (sink && frames.empty()) {
+			materialize(entries, sink);
+		}
+	}
+
+}
@@ -0,0 +1,27 @@
+#include "analysis/ProgramQueries.h"
+
+namespace spero::analysis {
+
+	GlobalDeclarations::Value GlobalDeclarations::compute(QueryEngine& engine, const Key&) {
+		Value decls;
+		for (auto stmt : engine.get<ProgramStatements>({})) {
+			for (auto& name : engine.get<StatementNames>(stmt).declared) {
+				decls[name].push_back(stmt);
+			}
+		}
+
+		return decls;
+	}
+
+	GlobalUses::Value GlobalUses::compute(QueryEngine& engine, const Key&) {
+		Value uses;
+		for (auto stmt : engine.get<ProgramStatements>({})) {
+			for (auto& name : engine.get<StatementNames>(stmt).required) {
+				uses[name].push_back(stmt);
+			}
+		}
+
+		return uses;
+	}
+
+}
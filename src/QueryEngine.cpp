@@ -0,0 +1,59 @@
+#include "analysis/QueryEngine.h"
+
+#include <algorithm>
+
+namespace spero::analysis {
+
+	void QueryEngine::refresh(Memo& memo) {
+		if (memo.is_input || memo.active || memo.verified_at == current) {
+			return;
+		}
+
+		// The old value can be reused if nothing it read has changed since it was last verified
+		// Checking a dependency brings it up to date first, so an unchanged recomputation stops the invalidation here
+		if (memo.has_value) {
+			bool unchanged = true;
+			for (auto* dep : memo.deps) {
+				refresh(*dep);
+
+				if (dep->changed_at > memo.verified_at) {
+					unchanged = false;
+					break;
+				}
+			}
+
+			if (unchanged) {
+				memo.verified_at = current;
+				return;
+			}
+		}
+
+		memo.deps.clear();
+		memo.active = true;
+		active.push_back(&memo);
+
+		bool changed = memo.recompute(*this);
+
+		active.pop_back();
+		memo.active = false;
+
+		if (changed) {
+			memo.changed_at = current;
+		}
+		memo.has_value = true;
+		memo.verified_at = current;
+	}
+
+	void QueryEngine::detach(const Memo& memo) {
+		// Readers lose their record of what they read, so they can't tell whether they're still valid
+		for (auto&[type, storage] : storages) {
+			storage->forEach([](Memo& reader, const Memo* removed) {
+				if (std::find(reader.deps.begin(), reader.deps.end(), removed) != reader.deps.end()) {
+					reader.deps.clear();
+					reader.has_value = false;
+				}
+			}, &memo);
+		}
+	}
+
+}
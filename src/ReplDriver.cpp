@@ -60,7 +60,7 @@ void ReplDriver::addInterpreterAstTransformations() {
 	if (exprs.size() > 0) {
 		auto location = exprs[0]->loc;
 		auto fn = std::make_unique<ast::Function>(std::deque<ptr<ast::Argument>>{}, std::make_unique<ast::Block>(std::move(exprs), location), location);
-		auto assign_name = std::make_unique<ast::AssignName>(std::make_unique<ast::BasicBinding>("jitfunc", ast::BindingType::VARIABLE, location), location);
+		auto assign_name = std::make_unique<ast::AssignName>(std::make_unique<ast::BasicBinding>(string::names::jitfunc, ast::BindingType::VARIABLE, location), location);
 		ast.push_back(std::make_unique<ast::VarAssign>(ast::VisibilityType::PUBLIC, std::move(assign_name), nullptr, nullptr, std::move(fn), location));
 	}
 }
@@ -77,7 +77,7 @@ void ReplDriver::interpretLlvm() {
 	llvm::Interpreter interpreter{ llvm::CloneModule(*translation_unit) };
 
 	// Extract the "runtime" function and params from the module to ensure we run our expected code
-	// NOTE: We currently only produce `jitfunc` to have type `() -> Int`
+	// NOTE: `jitfunc` returns the value of the last line, so its return type depends on that line
 	auto jitfn = interpreter.FindFunctionNamed("jitfunc");
 
 	// The repl line may just define values for future usage, so the jitfn may not be created
@@ -93,12 +93,18 @@ void ReplDriver::interpretLlvm() {
 #define TYPE(x) case llvm::Type::x##TyID
 		switch (jitfn->getReturnType()->getTypeID()) {
 			TYPE(Integer) :
-				output << res.IntVal << '\n';
+				if (res.IntVal.getBitWidth() == 1) {
+					output << (res.IntVal.getBoolValue() ? "true" : "false") << '\n';
+				} else {
+					output << res.IntVal << '\n';
+				}
+			break;
+			TYPE(Double) :
+				output << res.DoubleVal << '\n';
 			break;
 			TYPE(Void) :
 				TYPE(Half) :
 				TYPE(Float) :
-				TYPE(Double) :
 				TYPE(X86_FP80) :
 				TYPE(FP128) :
 				TYPE(PPC_FP128) :
@@ -124,11 +130,20 @@ void ReplDriver::interpretLlvm() {
 	}
 }
 
+bool ReplDriver::isExported(const ast::VarAssign&) {
+	return true;
+}
+
 bool ReplDriver::reset() {
 	auto failed = state.failed();
 
 	state.reset();
 	ast.erase(std::begin(ast), std::end(ast));
 
+	// Every node of the input is gone, so their ids (and the facts stored under them) can be reused
+	updateProgramQueries();
+	decls.forgetNodes();
+	state.nodeIds().reset();
+
 	return failed;
 }
@@ -0,0 +1,75 @@
+#include "analysis/SubtreePass.h"
+
+namespace spero::analysis {
+
+	using namespace compiler;
+
+	SubtreePass::SubtreePass(std::function<void(ast::Ast&)> fn) : fn{ std::move(fn) } {}
+
+
+	// Base Nodes
+	void SubtreePass::visitAst(ast::Ast& a) {
+		fn(a);
+	}
+	void SubtreePass::visitToken(ast::Token& t) {
+		fn(t);
+	}
+	void SubtreePass::visitStatement(ast::Statement& s) {
+		fn(s);
+		AstVisitor::visitStatement(s);
+	}
+
+
+	// Names
+	void SubtreePass::visitBasicBinding(ast::BasicBinding& b) {
+		fn(b);
+		AstVisitor::visitBasicBinding(b);
+	}
+	void SubtreePass::visitPathPart(ast::PathPart& p) {
+		fn(p);
+		AstVisitor::visitPathPart(p);
+	}
+	void SubtreePass::visitPath(ast::Path& p) {
+		fn(p);
+		AstVisitor::visitPath(p);
+	}
+	void SubtreePass::visitPattern(ast::Pattern& p) {
+		fn(p);
+		AstVisitor::visitPattern(p);
+	}
+	void SubtreePass::visitAssignPattern(ast::AssignPattern& p) {
+		fn(p);
+		AstVisitor::visitAssignPattern(p);
+	}
+
+
+	// Types
+	void SubtreePass::visitType(ast::Type& t) {
+		fn(t);
+		AstVisitor::visitType(t);
+	}
+
+
+	// Decorations
+	void SubtreePass::visitAnnotation(ast::Annotation& a) {
+		fn(a);
+		AstVisitor::visitAnnotation(a);
+	}
+	void SubtreePass::visitGenericPart(ast::GenericPart& g) {
+		fn(g);
+		AstVisitor::visitGenericPart(g);
+	}
+	void SubtreePass::visitGenericArray(ast::GenericArray& g) {
+		fn(g);
+		AstVisitor::visitGenericArray(g);
+	}
+	void SubtreePass::visitConstructor(ast::Constructor& c) {
+		fn(c);
+		AstVisitor::visitConstructor(c);
+	}
+	void SubtreePass::visitArgument(ast::Argument& a) {
+		fn(a);
+		AstVisitor::visitArgument(a);
+	}
+
+}
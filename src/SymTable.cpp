@@ -65,7 +65,7 @@ namespace spero::analysis {
 	SymTable::SymTable(SymIndex self, analysis::ScopingContext context)
 		: self_index{ self }, scope_context{ context }
 	{
-		insert("self", self);
+		insert(string::names::self, self);
 	}
 
 	// Basic accessors and queries
@@ -85,37 +85,24 @@ namespace spero::analysis {
 		return std::nullopt;
 	}
 
-	opt_t<SymTable::SymbolTypes> SymTable::get(const String& key, GenericInstanceIndexType index, compiler::Location loc, opt_t<size_t>& ssa_index) {
+	opt_t<SymTable::SymbolTypes> SymTable::get(const String& key, GenericInstanceIndexType index, opt_t<size_t>& ssa_index) {
 		// Drill down to the resolved instance
 		if (auto gen = get(key)) {
 			if (auto res = gen->get().resolve(index)) {
 			// Extract out the specific `SymbolInfo` struct if it exists
 				if (auto ssa_ref = std::get_if<ref_t<SsaVector>>(&*res)) {
-					// If we already know the ssa id, then just return it
+					// The ssa id is assigned by `VarRefPass` as it walks the ast in order
+					auto& ssa = ssa_ref->get();
 					if (ssa_index.has_value()) {
-						return ssa_ref->get()[*ssa_index];
-					}
-
-					// Otherwise we need to compute it by hand
-					// The easiest way being to find the first declaration that comes after the current location
-					// The referenced symbol declaration will be the vector entry before that declaration (if it exists)
-					auto ssa = &ssa_ref->get();
-					auto next_dec = std::upper_bound(ssa->begin(), ssa->end(), loc,
-						[&](auto&& use_loc, auto&& dec_loc) -> bool {
-							if (use_loc.line_num == dec_loc.src.line_num) {
-								return use_loc.byte < dec_loc.src.byte;
-							}
-
-							return use_loc.line_num < dec_loc.src.line_num;
-						});
-
-					if (next_dec != ssa->begin()) {
-						*ssa_index = std::distance(ssa->begin(), next_dec) - 1;
-						return *(next_dec - 1);
-
-					} else if (scope_context != +ScopingContext::SCOPE) {
-						*ssa_index = 0;
-						return *next_dec;
+						if (*ssa_index < ssa.size()) {
+							return ssa[*ssa_index];
+						}
+
+					// An unassigned id means the use comes before any declaration
+					// Only allowed in contexts that support forward usage, where it refers to the first declaration
+					} else if (scope_context != +ScopingContext::SCOPE && !ssa.empty()) {
+						ssa_index = 0;
+						return ssa.front();
 					}
 
 				// Otherwise, convert the expected types
@@ -130,6 +117,18 @@ namespace spero::analysis {
 		return std::nullopt;
 	}
 
+	size_t SymTable::numDefinitions(const String& key) {
+		if (auto gen = get(key)) {
+			if (auto res = gen->get().resolve(nullptr)) {
+				if (auto ssa_ref = std::get_if<ref_t<SsaVector>>(&*res)) {
+					return ssa_ref->get().size();
+				}
+			}
+		}
+
+		return 0;
+	}
+
 	// Mutation interfaces
 	bool SymTable::insert(const String& key, SymbolInfo value, bool exported) {
 		if (exported) {
@@ -163,6 +162,10 @@ namespace spero::analysis {
 
 		return false;
 	}
+	void SymTable::erase(const String& key) {
+		symbols.erase(key);
+		argument_set.erase(key);
+	}
 
 	// Analysis interfaces
 	SymIndex SymTable::self() const {
@@ -182,7 +185,7 @@ namespace spero::analysis {
 		return scope;
 	}
 	void SymTable::setParent(SymIndex p) {
-		insert("super", p);
+		insert(string::names::super, p);
 		parent = p;
 	}
 	void SymTable::setContext(ScopingContext rule) {
@@ -191,5 +194,25 @@ namespace spero::analysis {
 	ScopingContext SymTable::context() const {
 		return scope_context;
 	}
-	
+
+
+	void ScopedNames::enter(const SymArena& arena, SymIndex table) {
+		for (auto& [name, _] : arena[table]) {
+			bindings[name].push_back(table);
+		}
+	}
+	void ScopedNames::leave(const SymArena& arena, SymIndex table) {
+		for (auto& [name, _] : arena[table]) {
+			bindings[name].pop_back();
+		}
+	}
+	SymTable* ScopedNames::mostRecentDef(const String& key, SymArena& arena) const {
+		if (auto iter = bindings.find(key); iter != bindings.end() && !iter->second.empty()) {
+			return &arena[iter->second.back()];
+		}
+
+		auto& global = arena[GLOBAL_SYM_INDEX];
+		return global.exists(key) ? &global : nullptr;
+	}
+
 }
@@ -0,0 +1,164 @@
+#include "analysis/TypeUnifier.h"
+
+#include <unordered_set>
+
+namespace spero::analysis {
+
+	TypeVar TypeUnifier::fresh() {
+		auto var = static_cast<TypeVar>(classes.size());
+		classes.push_back(Class{ var });
+		return var;
+	}
+	TypeVar TypeUnifier::function(std::vector<TypeVar> args, TypeVar ret) {
+		args.push_back(ret);
+		return structured(TypeKind::FUNCTION, std::move(args));
+	}
+	TypeVar TypeUnifier::array(TypeVar elem) {
+		return structured(TypeKind::ARRAY, { elem });
+	}
+	TypeVar TypeUnifier::tuple(std::vector<TypeVar> elems) {
+		return structured(TypeKind::TUPLE, std::move(elems));
+	}
+	TypeVar TypeUnifier::known(const Type* type) {
+		// Only these kinds have a shape, anything else can only be bound as a whole
+		auto kind = type ? type->kind() : +TypeKind::NAMED;
+		if (kind != +TypeKind::FUNCTION && kind != +TypeKind::ARRAY && kind != +TypeKind::TUPLE) {
+			auto var = fresh();
+			classes[var].bound = type;
+			return var;
+		}
+
+		std::vector<TypeVar> parts;
+		for (auto* part : type->parts()) {
+			parts.push_back(known(part));
+		}
+		return structured(kind, std::move(parts));
+	}
+	TypeVar TypeUnifier::structured(TypeKind kind, std::vector<TypeVar> parts) {
+		auto var = fresh();
+		classes[var].shape = kind;
+		classes[var].parts = std::move(parts);
+		return var;
+	}
+
+	TypeVar TypeUnifier::find(TypeVar var) {
+		// Path halving: point every other node on the path at its grandparent
+		while (classes[var].parent != var) {
+			classes[var].parent = classes[classes[var].parent].parent;
+			var = classes[var].parent;
+		}
+
+		return var;
+	}
+
+	bool TypeUnifier::unify(TypeVar lhs, TypeVar rhs) {
+		bool consistent = true;
+
+		// Unifying two structured types requires unifying their components, which are queued here to avoid recursion
+		std::vector<std::pair<TypeVar, TypeVar>> work{ { lhs, rhs } };
+		while (!work.empty()) {
+			auto[a, b] = work.back();
+			work.pop_back();
+
+			a = find(a);
+			b = find(b);
+			if (a == b) {
+				continue;
+			}
+
+			// Union by rank, `a` becomes the representative of the merged class
+			if (classes[a].rank < classes[b].rank) {
+				std::swap(a, b);
+			}
+			auto& root = classes[a];
+			auto& child = classes[b];
+
+			if (root.bound && child.bound && root.bound != child.bound) {
+				last_conflict = { root.bound, child.bound };
+				consistent = false;
+			} else if (!root.bound) {
+				root.bound = child.bound;
+			}
+
+			if (child.shape) {
+				if (!root.shape) {
+					root.shape = child.shape;
+					root.parts = std::move(child.parts);
+
+				} else if (*root.shape != *child.shape || root.parts.size() != child.parts.size()) {
+					last_conflict = { nullptr, nullptr };
+					consistent = false;
+
+				} else {
+					for (size_t i = 0; i != root.parts.size(); ++i) {
+						work.emplace_back(root.parts[i], child.parts[i]);
+					}
+				}
+			}
+
+			// Structured types are currently only described by their components
+			if (root.shape && root.bound) {
+				last_conflict = { root.bound, nullptr };
+				consistent = false;
+			}
+
+			child.parent = a;
+			if (root.rank == child.rank) {
+				++root.rank;
+			}
+		}
+
+		return consistent;
+	}
+
+	bool TypeUnifier::bind(TypeVar var, const Type* type) {
+		auto& cls = classes[find(var)];
+
+		if (cls.shape || (cls.bound && cls.bound != type)) {
+			last_conflict = { cls.bound, type };
+			return false;
+		}
+
+		cls.bound = type;
+		return true;
+	}
+
+	const Type* TypeUnifier::resolve(TypeVar var, TypeInterner& types) {
+		std::unordered_set<TypeVar> active;
+
+		auto resolve_class = [&](auto& self, TypeVar var) -> const Type* {
+			var = find(var);
+			if (classes[var].bound || !classes[var].shape) {
+				return classes[var].bound;
+			}
+
+			// Recursive types (ie. `f = (x) -> x(x)`) have no finite representation
+			if (!active.insert(var).second) {
+				return nullptr;
+			}
+
+			std::vector<const Type*> parts;
+			for (auto part : classes[var].parts) {
+				if (auto* type = self(self, part)) {
+					parts.push_back(type);
+				} else {
+					return nullptr;
+				}
+			}
+
+			active.erase(var);
+			if (*classes[var].shape == +TypeKind::ARRAY) {
+				return types.array(parts.front());
+			} else if (*classes[var].shape == +TypeKind::TUPLE) {
+				return types.tuple(std::move(parts));
+			}
+
+			auto* ret = parts.back();
+			parts.pop_back();
+			return types.function(std::move(parts), ret);
+		};
+
+		return resolve_class(resolve_class, var);
+	}
+
+}
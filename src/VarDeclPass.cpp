@@ -9,14 +9,72 @@ namespace spero::analysis {
 	VarDeclPass::VarDeclPass(CompilationState& state, AnalysisState& dict) : dictionary{ dict }, state{ state } {}
 
 
+	/*
+	 * Determines whether a scope will have anything inserted into its SymTable
+	 *   Nested scopes are skipped as they're considered on their own once they're visited
+	 *   `self` and `super` paths need the scope's own table to resolve relative to it
+	 */
+	class ScopeScan : public ast::AstVisitor {
+		public:
+			bool needs_table = false;
+
+			virtual void visitArgument(ast::Argument&) final {
+				needs_table = true;
+			}
+			virtual void visitAssignName(ast::AssignName&) final {
+				needs_table = true;
+			}
+			virtual void visitPathPart(ast::PathPart& p) final {
+				needs_table |= p.name == string::names::self || p.name == string::names::super;
+			}
+
+			virtual void visitBlock(ast::Block&) final {}
+			virtual void visitInAssign(ast::InAssign&) final {}
+			virtual void visitFor(ast::For& f) final {
+				// The loop's binding lives in its own table
+				f.generator->accept(*this);
+			}
+			virtual void visitFunction(ast::Function& f) final {
+				// Arguments are declared before the function's scope is entered
+				needs_table |= !f.args.empty();
+			}
+	};
+
+	SymIndex VarDeclPass::openScope(bool needs_table) {
+		// Scopes that declare nothing share the table of their nearest materialized ancestor
+		// Lookups would have skipped over the empty table anyway, so this doesn't change resolution
+		if (!needs_table) {
+			return current;
+		}
+
+		// Tables released by an incremental compile are reused before the arena grows
+		SymIndex index;
+		if (!dictionary.free_tables.empty()) {
+			index = dictionary.free_tables.back();
+			dictionary.free_tables.pop_back();
+			dictionary.arena[index] = SymTable{ index, context };
+
+		} else {
+			index = dictionary.arena.size();
+			dictionary.arena.push_back(SymTable{ index, context });
+		}
+
+		dictionary.arena[index].setParent(current);
+		return index;
+	}
+
+
 	// Decorations
 	void VarDeclPass::visitArgument(ast::Argument& arg) {
 		// Create the VarData struct
 		SymbolInfo info{ arg.loc, false };
 
 		// Insert the new declaration into the table
-		if (!dictionary.arena[current].insertArg(arg.name->name, info)) {
+		auto& table = dictionary.arena[current];
+		if (!table.insertArg(arg.name->name, info)) {
 			state.log(ID::err, "Failed to insert argument symbol information: {} already existed <at {}>", arg.name->name, arg.loc);
+		} else {
+			dictionary.ssa_index[arg.id] = table.numDefinitions(arg.name->name) - 1;
 		}
 	}
 
@@ -28,18 +86,15 @@ namespace spero::analysis {
 	void VarDeclPass::visitBlock(ast::Block& b) {
 		auto parent_scope = current;
 
-		if (!b.locals.has_value()) {
-			b.locals = dictionary.arena.size();
-			current = *b.locals;
-
-			// Create the new SymTable in the arena
-			dictionary.arena.push_back(SymTable{ current, context });
-			dictionary.arena.back().setParent(parent_scope);
+		auto scope = dictionary.scope_of.at(b.id);
+		if (!scope) {
+			ScopeScan scan;
+			scan.AstVisitor::visitBlock(b);
 
-		} else {
-			current = *b.locals;
+			scope = dictionary.scope_of[b.id] = openScope(scan.needs_table);
 		}
 
+		current = *scope;
 		AstVisitor::visitBlock(b);
 
 		current = parent_scope;
@@ -48,14 +103,14 @@ namespace spero::analysis {
 
 	void VarDeclPass::visitFunction(ast::Function& f) {
 		auto parent_scope = current;
-		f.body->locals = dictionary.arena.size();
 
 		auto parent_context = context;
 		context = ScopingContext::SCOPE;
 
-		// Create the SymTable in the arena
-		dictionary.arena.push_back(SymTable{ *f.body->locals, context });
-		dictionary.arena.back().setParent(parent_scope);
+		// Create the SymTable for the function body
+		ScopeScan scan;
+		scan.AstVisitor::visitBlock(*f.body);
+		dictionary.scope_of[f.body->id] = openScope(scan.needs_table);
 
 		AstVisitor::visitFunction(f);
 
@@ -73,7 +128,7 @@ namespace spero::analysis {
 
 			// Tell the function what it's name is (for analysis/assembly generation)
 			if (auto* fn = dynamic_cast<ast::Function*>(var->expr.get())) {
-				fn->name = n.var->name;
+				dictionary.fn_name[fn->id] = n.var->name;
 			}
 			
 		} else if (auto* type = dynamic_cast<ast::TypeAssign*>(current_decl)) {
@@ -82,28 +137,65 @@ namespace spero::analysis {
 		}
 		
 		// Insert the new declaration into the table
-		if (!dictionary.arena[current].insert(n.var->name, info)) {
+		auto& table = dictionary.arena[current];
+		if (!table.insert(n.var->name, info)) {
 			state.log(ID::err, "Failed to insert symbol information: {} already bound to an import or SymTable <at {}>", n.var->name, n.loc);
+		} else {
+			dictionary.ssa_index[n.id] = table.numDefinitions(n.var->name) - 1;
 		}
 	}
 
 
 	// Control
+	void VarDeclPass::visitFor(ast::For& f) {
+		// TODO: Destructure the elements once patterns are supported elsewhere
+		// Until then anything but a single immutable name (or `_`) is rejected here, so no other pass has to handle it
+		auto* var = dynamic_cast<ast::VarPattern*>(f.pattern.get());
+		auto is_name = var && typeid(*var) == typeid(ast::VarPattern) && var->name->elems.size() == 1;
+		auto is_any = typeid(*f.pattern) == typeid(ast::Pattern);
+		if (f.pattern->cap != +ast::CaptureType::NORM || !(is_name || is_any)) {
+			state.log(ID::err, "For loops can only bind a single immutable name <at {}>", f.pattern->loc);
+			return;
+		}
+
+		// The generator is evaluated once, before the loop's scope is entered
+		f.generator->accept(*this);
+
+		auto parent_scope = current;
+		auto parent_context = context;
+		context = ScopingContext::SCOPE;
+
+		// The loop has its own table for the name it binds (like `InAssign`)
+		current = openScope(is_name);
+		dictionary.scope_of[f.id] = current;
+
+		if (is_name) {
+			auto& name = var->name->elems.back()->name;
+			auto& table = dictionary.arena[current];
+			table.insert(name, SymbolInfo{ var->loc, false });
+			dictionary.ssa_index[var->id] = table.numDefinitions(name) - 1;
+		}
+
+		f.body->accept(*this);
+
+		context = parent_context;
+		current = parent_scope;
+	}
 
 
 	// Statements
 	void VarDeclPass::visitInAssign(ast::InAssign& in) {
 		auto parent_scope = current;
-		in.binding = dictionary.arena.size();
-		current = *in.binding;
 
 		auto parent_context = context;
 		context = ScopingContext::SCOPE;
 
-		// Create the new SymTable in the arena
-		dictionary.arena.push_back(SymTable{ current, context });
-		dictionary.arena.back().setParent(parent_scope);
-		
+		// Create the new SymTable for the binding
+		ScopeScan scan;
+		scan.AstVisitor::visitInAssign(in);
+		current = openScope(scan.needs_table);
+		dictionary.scope_of[in.id] = current;
+
 		AstVisitor::visitInAssign(in);
 
 		context = parent_context;
@@ -7,14 +7,19 @@ namespace spero::analysis {
 	VarRefPass::VarRefPass(CompilationState& state, AnalysisState& dict) : dictionary{ dict }, state{ state } {}
 
 
-	// Atoms
-	void VarRefPass::visitBlock(ast::Block& b) {
-		auto parent_scope = current;
-		current = *b.locals;
+	// Decorations
+	void VarRefPass::visitArgument(ast::Argument& arg) {
+		if (auto ssa_index = dictionary.ssa_index.at(arg.id)) {
+			definitions[current][arg.name->name] = *ssa_index;
+		}
+
+		AstVisitor::visitArgument(arg);
+	}
 
-		AstVisitor::visitBlock(b);
 
-		current = parent_scope;
+	// Atoms
+	void VarRefPass::visitBlock(ast::Block& b) {
+		withScope(*dictionary.scope_of.at(b.id), [&]() { AstVisitor::visitBlock(b); });
 	}
 	void VarRefPass::visitFunction(ast::Function& f) {
 		auto parent_context = context;
@@ -26,10 +31,30 @@ namespace spero::analysis {
 	}
 
 
+	// Control
+	void VarRefPass::visitFor(ast::For& f) {
+		// The generator can't see the loop's binding
+		f.generator->accept(*this);
+
+		auto scope = dictionary.scope_of.at(f.id);
+		if (!scope) {
+			return;
+		}
+
+		withScope(*scope, [&]() {
+			if (auto* var = dynamic_cast<ast::VarPattern*>(f.pattern.get())) {
+				definitions[current][var->name->elems.back()->name] = *dictionary.ssa_index.at(var->id);
+			}
+
+			f.body->accept(*this);
+		});
+	}
+
+
 	// Expressions
 	void VarRefPass::visitVariable(ast::Variable& v) {
 		// Perform some simple variable usage checks
-		auto[def_table, iter] = lookup(dictionary.arena, current, *v.name);
+		auto[def_table, iter] = lookup(dictionary, current, *v.name, &visible);
 
 		if (iter + 1 != std::end(v.name->elems)) {
 			state.log(ID::err, "Attempt to use undeclared variable `{}` <at {}>", *v.name, v.loc);
@@ -37,14 +62,22 @@ namespace spero::analysis {
 		}
 
 		auto& path_part = **iter;
-		auto nvar = dictionary.arena[def_table].get(path_part.name, nullptr, path_part.loc, path_part.ssa_index);
+		auto& ssa_index = dictionary.ssa_index[path_part.id];
+		if (!ssa_index.has_value()) {
+			auto& defs = definitions[def_table];
+			if (auto def = defs.find(path_part.name); def != defs.end()) {
+				ssa_index = def->second;
+			}
+		}
+
+		auto nvar = dictionary.arena[def_table].get(path_part.name, nullptr, ssa_index);
 		if (nvar) {
 			if (!std::holds_alternative<ref_t<SymbolInfo>>(*nvar)) {
 				state.log(ID::err, "Attempt to use non-variable symbol `{}` as a variable <at {}>", *v.name, v.loc);
 
 			// If the lookup succeeded to find a declaration, set the `def_table` member to point to the definition table to speed up future lookups
 			} else {
-				v.def_table = def_table;
+				dictionary.def_table[v.id] = def_table;
 			}
 
 		// If the variable is bound, but 'get' gives nullopt, then declaration must happen after the use
@@ -59,7 +92,7 @@ namespace spero::analysis {
 		AstVisitor::visitBinOpCall(b);
 
 		// Handle variable reassignment issues
-		if (b.op == "=") {
+		if (b.op == string::names::assign) {
 			auto* lhs = dynamic_cast<ast::Variable*>(b.lhs.get());
 			if (!lhs) {
 				state.log(ID::err, "Attempt to reassign a non-variable value <at {}>", lhs->loc);
@@ -68,17 +101,18 @@ namespace spero::analysis {
 
 			// Make sure to disallow assignment to language "keywords"
 			auto& most_qualified_part = lhs->name->elems.back();
-			if (most_qualified_part->name == "self" || most_qualified_part->name == "super") {
+			if (most_qualified_part->name == string::names::self || most_qualified_part->name == string::names::super) {
 				state.log(ID::err, "Attempt to reassign `{}` keyword <at {}>", most_qualified_part, lhs->loc);
 				return;
 			}
-			if (!lhs->def_table.has_value()) {
+			auto def_table = dictionary.def_table.at(lhs->id);
+			if (!def_table.has_value()) {
 				state.log(ID::err, "Attempt to reassign unknown variable `{}` <at {}>", most_qualified_part->name, lhs->loc);
 				return;
 			}
 
 			// Check whether the variable was declared as immutable
-			if (auto nvar = dictionary.arena[*lhs->def_table].get(most_qualified_part->name, nullptr, most_qualified_part->loc, most_qualified_part->ssa_index)) {
+			if (auto nvar = dictionary.arena[*def_table].get(most_qualified_part->name, nullptr, dictionary.ssa_index[most_qualified_part->id])) {
 				if (auto* var = std::get_if<ref_t<SymbolInfo>>(&*nvar); !var->get().is_mut) {
 					state.log(ID::err, "Attempt to reassign immutable variable `{}` <at {}>", *lhs->name, lhs->loc);
 				}
@@ -87,18 +121,24 @@ namespace spero::analysis {
 	}
 
 
+	// Names
+	void VarRefPass::visitAssignName(ast::AssignName& n) {
+		if (auto ssa_index = dictionary.ssa_index.at(n.id)) {
+			definitions[current][n.var->name] = *ssa_index;
+		}
+
+		AstVisitor::visitAssignName(n);
+	}
+
+
 	// Statements
 	void VarRefPass::visitInAssign(ast::InAssign& in) {
-		auto parent_scope = current;
-		current = *in.binding;
-
 		auto parent_context = context;
 		context = ScopingContext::SCOPE;
 
-		AstVisitor::visitInAssign(in);
+		withScope(*dictionary.scope_of.at(in.id), [&]() { AstVisitor::visitInAssign(in); });
 
 		context = parent_context;
-		current = parent_scope;
 	}
 
 	void VarRefPass::visitTypeAssign(ast::TypeAssign& t) {
@@ -110,5 +150,17 @@ namespace spero::analysis {
 		context = parent_context;
 	}
 
+	void VarRefPass::visitVarAssign(ast::VarAssign& v) {
+		// Functions are in scope within their own definition (ie. recursion), so their names are visited first
+		// Other values are visited first, so that `let x = x + 1` refers to the `x` it shadows
+		if (dynamic_cast<ast::Function*>(v.expr.get())) {
+			visitInterface(v);
+			v.expr->accept(*this);
+
+		} else {
+			AstVisitor::visitVarAssign(v);
+		}
+	}
+
 
 }
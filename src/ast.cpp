@@ -1,4 +1,5 @@
 #include "parser/AstVisitor.h"
+#include "analysis/AnalysisState.h"
 #include "util/ranges.h"
 
 namespace spero::compiler::ast {
@@ -16,7 +17,35 @@ namespace spero::compiler::ast {
 	// BASE NODES: AST, VALEXPR, STMT
 	// 
 
-	Ast::Ast(Location loc) : loc{ loc } {}
+	// Node ids
+	NodeId NodeIds::next() {
+		return next_id++;
+	}
+	void NodeIds::reset() {
+		next_id = 0;
+	}
+
+	namespace {
+		thread_local NodeIds* current_ids = nullptr;
+	}
+
+	NodeIds& currentIds() {
+		if (current_ids) {
+			return *current_ids;
+		}
+
+		static NodeIds process_ids;
+		return process_ids;
+	}
+
+	NodeIdScope::NodeIdScope(NodeIds& ids) : prev{ current_ids } {
+		current_ids = &ids;
+	}
+	NodeIdScope::~NodeIdScope() {
+		current_ids = prev;
+	}
+
+	Ast::Ast(Location loc) : loc{ loc }, id{ currentIds().next() } {}
 	void Ast::accept(AstVisitor& v) {
 		v.visitAst(*this);
 	}
@@ -95,7 +124,7 @@ namespace spero::compiler::ast {
 		return ValExpr::prettyPrint(s, buf);
 	}
 
-	Byte::Byte(const std::string& val, int base, Location loc) : Literal{ loc }, val{ std::stoul(val, nullptr, base) } {}
+	Byte::Byte(unsigned long val, Location loc) : Literal{ loc }, val{ val } {}
 	void Byte::accept(AstVisitor& v) {
 		v.visitByte(*this);
 	}
@@ -105,7 +134,7 @@ namespace spero::compiler::ast {
 		return ValExpr::prettyPrint(s, buf);
 	}
 
-	Float::Float(const std::string& num, Location loc) : Literal{ loc }, val{ std::stof(num) } {}
+	Float::Float(double num, Location loc) : Literal{ loc }, val{ num } {}
 	void Float::accept(AstVisitor& v) {
 		v.visitFloat(*this);
 	}
@@ -115,7 +144,7 @@ namespace spero::compiler::ast {
 		return ValExpr::prettyPrint(s, buf);
 	}
 
-	Int::Int(const std::string& num, Location loc) : Literal{ loc }, val{ std::stol(num) } {}
+	Int::Int(long num, Location loc) : Literal{ loc }, val{ num } {}
 	void Int::accept(AstVisitor& v) {
 		v.visitInt(*this);
 	}
@@ -245,8 +274,6 @@ namespace spero::compiler::ast {
 	}
 	DEF_PRINTER(PathPart) {
 		s << name;
-		if (sym_index) s << '@' << *sym_index;
-		if (ssa_index) s << '$' << *ssa_index;
 		if (gens) s << "[_]";
 		return s;
 		//return s << std::string(buf, ' ') << context << "ast.PathPart (var=" << name << ", type=" << type._to_string() << ")";
@@ -879,10 +906,21 @@ namespace spero::compiler::ast {
 		return body->prettyPrint(s << '\n', buf + 2, "body=");
 	}
 
+	// Every name that a value is destructured into shares the value's mutability
+	static void setMutability(AssignPattern& pattern, bool is_mut) {
+		pattern.is_mut = is_mut;
+
+		if (auto* tuple = dynamic_cast<AssignTuple*>(&pattern)) {
+			for (auto& elem : tuple->elems) {
+				setMutability(*elem, is_mut);
+			}
+		}
+	}
+
 	VarAssign::VarAssign(VisibilityType vis, ptr<AssignPattern> binding, ptr<GenericArray> gen_pattern, ptr<Type> type_bound, ptr<ValExpr> value, Location loc)
 		: Interface{ vis, std::move(binding), std::move(gen_pattern), std::move(type_bound), loc }, expr{ std::move(value) }
 	{
-		name->is_mut = expr->is_mut;
+		setMutability(*name, expr->is_mut);
 	}
 	void VarAssign::accept(AstVisitor& v) {
 		v.visitVarAssign(*this);
@@ -1040,13 +1078,15 @@ namespace spero::compiler::ast {
 
 namespace spero::analysis {
 
-	std::tuple<SymIndex, compiler::ast::Path::iterator> lookup(SymArena& arena, SymIndex current, compiler::ast::Path& var_path) {
+	std::tuple<SymIndex, compiler::ast::Path::iterator> lookup(AnalysisState& dict, SymIndex current, compiler::ast::Path& var_path, const ScopedNames* names) {
+		auto& arena = dict.arena;
 		auto[front, end] = util::range(var_path.elems);
 		bool has_next = true;
 
 		// Support forced global indexing (through ':<>') (NOTE: Undecided on inclusion in final document)
 		if (!(**front).name.get().empty()) {
-			auto def = arena[current].mostRecentDef((**front).name, arena);
+			auto def = names ? names->mostRecentDef((**front).name, arena)
+							 : arena[current].mostRecentDef((**front).name, arena);
 			current = def ? def->self() : current;
 			has_next = def != nullptr;
 
@@ -1058,12 +1098,13 @@ namespace spero::analysis {
 		// Follow the symbol path to it's end
 		while (front != end && has_next) {
 			// If we've already figured out where this "part" points to, then we don't need to do it again
-			if (front->get()->sym_index.has_value() && current != *front->get()->sym_index) {
-				current = *front->get()->sym_index;
+			auto id = front->get()->id;
+			if (auto index = dict.sym_index.at(id); index && current != *index) {
+				current = *index;
 				++front;
 				continue;
 			}
-			if (front->get()->ssa_index.has_value()) {
+			if (dict.ssa_index.at(id)) {
 				break;
 			}
 
@@ -1078,7 +1119,7 @@ namespace spero::analysis {
 					// Now check that the symbol stored is a SymIndex
 					if (auto index = std::get_if<SymIndex>(&*resolved)) {
 						current = *index;
-						front->get()->sym_index = *index;
+						dict.sym_index[id] = *index;
 						++front;
 
 					// TODO: Handle `redirect`
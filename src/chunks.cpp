@@ -0,0 +1,148 @@
+#include "parser/chunks.h"
+
+#include <algorithm>
+#include <cctype>
+#include <optional>
+
+namespace spero::parser {
+
+	static bool isIdentChar(char ch) {
+		return std::isalnum(static_cast<unsigned char>(ch)) || ch == '_';
+	}
+
+	static bool startsDeclaration(std::string_view line) {
+		for (std::string_view key : { "let", "def", "mod", "use", "impl" }) {
+			if (line.substr(0, key.size()) == key && (line.size() == key.size() || !isIdentChar(line[key.size()]))) {
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	// Fill in the text of every chunk now that the end of every chunk is known
+	static std::vector<Chunk> fillText(std::vector<Chunk> chunks, std::string_view src) {
+		for (size_t i = 0; i != chunks.size(); ++i) {
+			auto end = (i + 1 == chunks.size()) ? src.size() : chunks[i + 1].byte;
+			chunks[i].text = src.substr(chunks[i].byte, end - chunks[i].byte);
+		}
+
+		return std::move(chunks);
+	}
+
+	// NOTE: This mirrors the lexical rules of the grammar
+	std::vector<Chunk> splitAtDeclarations(std::string_view src) {
+		std::vector<Chunk> boundaries{ Chunk{ {}, 0, 1 } };
+		std::optional<Chunk> annotations;
+		size_t line = 1, depth = 0, i = 0;
+
+		auto skip = [&](size_t n) {
+			for (auto end = std::min(i + n, src.size()); i < end; ++i) {
+				line += (src[i] == '\n');
+			}
+		};
+
+		while (i < src.size()) {
+			if (depth == 0 && (i == 0 || src[i - 1] == '\n')) {
+				auto rest = src.substr(i);
+
+				// Keep annotations with the statement they are attached to
+				if (rest[0] == '@') {
+					if (!annotations) {
+						annotations = Chunk{ {}, i, line };
+					}
+
+				} else if (startsDeclaration(rest)) {
+					auto boundary = annotations.value_or(Chunk{ {}, i, line });
+					if (boundary.byte != 0) {
+						boundaries.push_back(boundary);
+					}
+					annotations = std::nullopt;
+
+				} else if (rest[0] != '\n' && rest[0] != '\r') {
+					annotations = std::nullopt;
+				}
+			}
+
+			switch (src[i]) {
+				case '"':
+					skip(1);
+					while (i < src.size() && src[i] != '"') {
+						skip(src[i] == '\\' ? 2 : 1);
+					}
+					skip(1);
+					break;
+
+				case '\'':
+					skip(1);
+					if (i < src.size()) {
+						skip(src[i] == '\\' ? 2 : 1);
+					}
+					if (i < src.size() && src[i] == '\'') {
+						skip(1);
+					}
+					break;
+
+				case '#':
+					if (src.substr(i, 2) == "##") {
+						auto end = src.find("##", i + 2);
+						skip(end == std::string_view::npos ? src.size() : end + 2 - i);
+					} else {
+						auto end = src.find('\n', i);
+						skip(end == std::string_view::npos ? src.size() : end - i);
+					}
+					break;
+
+				case '{': case '(': case '[':
+					++depth;
+					skip(1);
+					break;
+
+				case '}': case ')': case ']':
+					depth -= (depth != 0);
+					skip(1);
+					break;
+
+				default:
+					skip(1);
+			}
+		}
+
+		return fillText(std::move(boundaries), src);
+	}
+
+	std::vector<Chunk> splitTopLevel(std::string_view src, size_t max_chunks, size_t min_chunk_size) {
+		auto num_chunks = std::clamp<size_t>(src.size() / std::max<size_t>(min_chunk_size, 1), 1, std::max<size_t>(max_chunks, 1));
+		if (num_chunks == 1) {
+			return { Chunk{ src, 0, 1 } };
+		}
+
+		auto target = src.size() / num_chunks;
+		std::vector<Chunk> chunks{ Chunk{ {}, 0, 1 } };
+
+		for (auto& boundary : splitAtDeclarations(src)) {
+			if (boundary.byte - chunks.back().byte >= target && chunks.size() < num_chunks) {
+				chunks.push_back(boundary);
+			}
+		}
+
+		return fillText(std::move(chunks), src);
+	}
+
+	TextEdit diffSources(std::string_view before, std::string_view after) {
+		auto shortest = std::min(before.size(), after.size());
+
+		size_t prefix = 0;
+		while (prefix != shortest && before[prefix] == after[prefix]) {
+			++prefix;
+		}
+
+		size_t suffix = 0;
+		while (suffix != shortest - prefix && before[before.size() - suffix - 1] == after[after.size() - suffix - 1]) {
+			++suffix;
+		}
+
+		return TextEdit{ prefix, before.size() - suffix, after.substr(prefix, after.size() - suffix - prefix) };
+	}
+
+}
@@ -21,6 +21,10 @@ namespace spero::cmd {
 			("W,warn", "Turn compilation warnings into errors", value<std::vector<std::string>>())
 			("A,allow", "Turn compilation warnings into logs", value<std::vector<std::string>>())
 			("L,showlog", "Display log messages along with warnings and errors")
+			("j,jobs", "Number of threads used to parse a single input file", value<size_t>()->default_value("1"))
+			("emit-ast", "Write the parsed ast to the given file (which can be compiled in place of the source)", value<std::string>())
+			("stream", "Analyze and translate each top-level statement while the rest of the input is still being parsed")
+			("edit", "Compile the input, then recompile it incrementally after it was edited into the given file", value<std::string>())
 			("target", "Set the compilation target", value<std::string>()->default_value("win10"))
 			("O", "Specify the optimization level", value<char>()->default_value("0"))
 			("o,out", "Specify output file", value<std::string>()->default_value("out.exe"));
@@ -39,13 +43,12 @@ namespace spero::cmd {
 		// Use the cxxopts library to parse out basic interfaces
 		auto res = opts.parse(argc, argv);
 
-		// Construct the compilation state
-		compiler::OptionState<cxxopts::ParseResult> state{ argv + 1, argv + argc, std::move(res) };
+		auto fst = argv + 1, snd = argv + argc;
 		argc = 1;
 
-		// init state
-
-		return state;
+		// Construct the compilation state
+		// NOTE: The state owns the interner and atomics, so it can't be moved and must be constructed in place
+		return compiler::OptionState<cxxopts::ParseResult>{ fst, snd, std::move(res) };
 	}
 
 }
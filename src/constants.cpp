@@ -0,0 +1,118 @@
+#include "analysis/constants.h"
+
+#include <limits>
+
+namespace spero::analysis {
+
+	// Checked integer arithmetic, as a folded overflow would differ from the (wrapping) generated code
+	static opt_t<int64_t> checkedInt(const String& op, int64_t lhs, int64_t rhs) {
+		static constexpr auto min = std::numeric_limits<int64_t>::min();
+		static constexpr auto max = std::numeric_limits<int64_t>::max();
+
+		if (op == "+") {
+			if ((rhs > 0 && lhs > max - rhs) || (rhs < 0 && lhs < min - rhs)) {
+				return std::nullopt;
+			}
+			return lhs + rhs;
+
+		} else if (op == "-") {
+			if ((rhs < 0 && lhs > max + rhs) || (rhs > 0 && lhs < min + rhs)) {
+				return std::nullopt;
+			}
+			return lhs - rhs;
+
+		} else if (op == "*") {
+			if (lhs != 0 && rhs != 0) {
+				auto result = static_cast<int64_t>(static_cast<uint64_t>(lhs) * static_cast<uint64_t>(rhs));
+				if ((lhs == -1 && rhs == min) || (rhs == -1 && lhs == min) || result / rhs != lhs) {
+					return std::nullopt;
+				}
+				return result;
+			}
+			return 0;
+
+		} else if (op == "/" || op == "%") {
+			if (rhs == 0 || (lhs == min && rhs == -1)) {
+				return std::nullopt;
+			}
+			return op == "/" ? lhs / rhs : lhs % rhs;
+		}
+
+		return std::nullopt;
+	}
+
+	template<class T>
+	static opt_t<ConstValue> compare(const String& op, const T& lhs, const T& rhs) {
+		if (op == "==") {
+			return lhs == rhs;
+		} else if (op == "!=") {
+			return lhs != rhs;
+		} else if (op == "<") {
+			return lhs < rhs;
+		} else if (op == "<=") {
+			return lhs <= rhs;
+		} else if (op == ">") {
+			return lhs > rhs;
+		} else if (op == ">=") {
+			return lhs >= rhs;
+		}
+
+		return std::nullopt;
+	}
+
+	opt_t<ConstValue> evalUnary(const String& op, const ConstValue& expr) {
+		if (op == "-") {
+			if (auto* i = std::get_if<int64_t>(&expr); i && *i != std::numeric_limits<int64_t>::min()) {
+				return -*i;
+			} else if (auto* f = std::get_if<double>(&expr)) {
+				return -*f;
+			}
+
+		} else if (op == "!") {
+			if (auto* b = std::get_if<bool>(&expr)) {
+				return !*b;
+			}
+		}
+
+		return std::nullopt;
+	}
+
+	opt_t<ConstValue> evalBinary(const String& op, const ConstValue& lhs, const ConstValue& rhs) {
+		// Typing has already checked that both sides have the same type
+		if (lhs.index() != rhs.index()) {
+			return std::nullopt;
+		}
+
+		return std::visit([&](auto&& l) -> opt_t<ConstValue> {
+			using T = std::decay_t<decltype(l)>;
+			auto& r = std::get<T>(rhs);
+
+			if constexpr (std::is_same_v<T, bool>) {
+				if (op == "&&") {
+					return l && r;
+				} else if (op == "||") {
+					return l || r;
+				}
+
+			} else if constexpr (std::is_same_v<T, int64_t>) {
+				if (auto result = checkedInt(op, l, r)) {
+					return *result;
+				}
+
+			} else if constexpr (std::is_same_v<T, double>) {
+				if (op == "+") {
+					return l + r;
+				} else if (op == "-") {
+					return l - r;
+				} else if (op == "*") {
+					return l * r;
+				} else if (op == "/") {
+					return l / r;
+				}
+			}
+
+			return compare(op, l, r);
+		}, lhs);
+	}
+
+}
@@ -0,0 +1,77 @@
+#include "util/mapped_file.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace spero::util {
+
+#ifdef _WIN32
+	MappedFile::MappedFile(const std::string& path) {
+		file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE) {
+			file = nullptr;
+			return;
+		}
+
+		LARGE_INTEGER file_size;
+		if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+			return;
+		}
+
+		mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!mapping) {
+			return;
+		}
+
+		data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+		size = data ? static_cast<size_t>(file_size.QuadPart) : 0;
+	}
+
+	MappedFile::~MappedFile() {
+		if (data) {
+			UnmapViewOfFile(data);
+		}
+		if (mapping) {
+			CloseHandle(mapping);
+		}
+		if (file) {
+			CloseHandle(file);
+		}
+	}
+
+#else
+	MappedFile::MappedFile(const std::string& path) {
+		auto fd = open(path.c_str(), O_RDONLY);
+		if (fd < 0) {
+			return;
+		}
+
+		struct stat info;
+		if (fstat(fd, &info) == 0 && info.st_size > 0) {
+			auto* mem = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+			if (mem != MAP_FAILED) {
+				data = static_cast<const char*>(mem);
+				size = static_cast<size_t>(info.st_size);
+			}
+		}
+
+		// The mapping stays valid after the descriptor is closed
+		close(fd);
+	}
+
+	MappedFile::~MappedFile() {
+		if (data) {
+			munmap(const_cast<char*>(data), size);
+		}
+	}
+#endif
+
+}
@@ -0,0 +1,903 @@
+#include "parser/serialize.h"
+
+#include <cstring>
+#include <iterator>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+#include "util/parser.h"
+
+namespace spero::parser {
+
+	using namespace compiler;
+	using namespace compiler::ast;
+
+	// NOTE: Kinds are stored in the file, so new node types must only ever be appended
+#define SPERO_AST_NODES(X) \
+	X(Ast) X(Token) X(Type) X(Statement) X(ValExpr) \
+	X(Bool) X(Byte) X(Float) X(Int) X(Char) X(String) X(Future) X(Tuple) X(Array) X(Block) X(Function) \
+	X(BasicBinding) X(PathPart) X(Path) X(Pattern) X(TuplePattern) X(VarPattern) X(AdtPattern) X(ValPattern) \
+	X(AssignPattern) X(AssignName) X(AssignTuple) \
+	X(SourceType) X(GenericType) X(TupleType) X(FunctionType) X(AndType) X(OrType) \
+	X(Annotation) X(LocalAnnotation) X(GenericPart) X(TypeGeneric) X(ValueGeneric) X(LitGeneric) X(GenericArray) \
+	X(Adt) X(TypeAnnotation) X(Argument) X(ArgTuple) \
+	X(Branch) X(Loop) X(While) X(For) X(IfBranch) X(IfElse) X(Case) X(Match) X(Jump) \
+	X(ModDec) X(ImplExpr) X(SingleImport) X(MultipleImport) X(Rebind) \
+	X(Interface) X(TypeAssign) X(VarAssign) X(TypeExtension) \
+	X(InAssign) X(Variable) X(UnOpCall) X(BinOpCall) X(Index) X(FnCall) \
+	X(Symbol) X(Error) X(CloseSymbolError) X(ValError) X(TypeError) X(ScopeError)
+
+	enum class NodeKind : uint8_t {
+		Null,
+#define X(node) node,
+		SPERO_AST_NODES(X)
+#undef X
+		NumKinds
+	};
+
+	// Header layout: magic, version, byte order mark, number of strings, number of top-level nodes
+	static constexpr char magic[4] = { 'S', 'P', 'R', 'A' };
+	static constexpr uint32_t version = 2;
+	static constexpr uint32_t byte_order = 0x01020304;
+	static constexpr size_t header_size = sizeof(magic) + 4 * sizeof(uint32_t);
+
+
+	//
+	// Writing
+	//
+	class AstWriter {
+		std::string nodes;
+		std::unordered_map<std::string_view, uint32_t> string_ids;
+		std::vector<std::string_view> strings;
+
+		template<class T>
+		void raw(const T& val) {
+			nodes.append(reinterpret_cast<const char*>(&val), sizeof(T));
+		}
+
+		void str(std::string_view s) {
+			auto [iter, inserted] = string_ids.emplace(s, static_cast<uint32_t>(strings.size()));
+			if (inserted) {
+				strings.push_back(s);
+			}
+			raw(iter->second);
+		}
+
+		public:
+			template<class T>
+			std::enable_if_t<std::is_arithmetic_v<T>> put(T val) { raw(val); }
+			template<class E>
+			auto put(E val) -> decltype(val._to_integral(), void()) { raw(val._to_integral()); }
+			void put(const spero::String& s) { str(s.get()); }
+			void put(const std::string& s) { str(s); }
+			void put(const Location& loc) {
+				put(static_cast<uint32_t>(loc.line_num));
+				put(static_cast<uint32_t>(loc.byte));
+				put(loc.source);
+			}
+			template<class N>
+			void put(const std::deque<ptr<N>>& seq) {
+				put(static_cast<uint32_t>(seq.size()));
+				for (auto& node : seq) {
+					put(node.get());
+				}
+			}
+			template<class N>
+			void put(const ptr<N>& node) { put(static_cast<const Ast*>(node.get())); }
+			void put(const Ast* node);
+
+			// Fields shared through the base classes are written after the node's own fields
+			void putTail(const Ast& node) {
+				if (auto* stmt = dynamic_cast<const Statement*>(&node)) {
+					put(stmt->annots);
+				}
+				if (auto* val = dynamic_cast<const ValExpr*>(&node)) {
+					put(val->is_mut);
+				}
+				if (auto* pat = dynamic_cast<const Pattern*>(&node)) {
+					put(pat->cap);
+				}
+				if (auto* pat = dynamic_cast<const AssignPattern*>(&node)) {
+					put(pat->is_mut);
+				}
+				if (auto* typ = dynamic_cast<const ast::Type*>(&node)) {
+					put(typ->is_mut);
+				}
+				if (auto* typ = dynamic_cast<const SourceType*>(&node)) {
+					put(typ->_ptr);
+				}
+			}
+
+			std::string finish(uint32_t num_roots) {
+				std::string out;
+				out.append(magic, sizeof(magic));
+
+				for (uint32_t field : { version, byte_order, static_cast<uint32_t>(strings.size()), num_roots }) {
+					out.append(reinterpret_cast<const char*>(&field), sizeof(field));
+				}
+
+				for (auto s : strings) {
+					auto size = static_cast<uint32_t>(s.size());
+					out.append(reinterpret_cast<const char*>(&size), sizeof(size));
+					out.append(s);
+				}
+
+				return out + nodes;
+			}
+	};
+
+	static NodeKind kindOf(const Ast& node) {
+		static const std::unordered_map<std::type_index, NodeKind> kinds{
+#define X(node) { typeid(ast::node), NodeKind::node },
+			SPERO_AST_NODES(X)
+#undef X
+		};
+
+		auto iter = kinds.find(typeid(node));
+		return (iter == kinds.end()) ? NodeKind::Null : iter->second;
+	}
+
+	void AstWriter::put(const Ast* node) {
+		auto kind = node ? kindOf(*node) : NodeKind::Null;
+		raw(kind);
+		if (kind == NodeKind::Null) {
+			return;
+		}
+
+		put(node->loc);
+
+		switch (kind) {
+			case NodeKind::Token: {
+				auto& n = static_cast<const ast::Token&>(*node);
+				put(static_cast<uint8_t>(n.value.index()));
+				std::visit([&](auto val) { put(val); }, n.value);
+				break;
+			}
+			case NodeKind::Bool: put(static_cast<const Bool*>(node)->val); break;
+			case NodeKind::Byte: put(static_cast<uint64_t>(static_cast<const Byte*>(node)->val)); break;
+			case NodeKind::Float: put(static_cast<const Float*>(node)->val); break;
+			case NodeKind::Int: put(static_cast<int64_t>(static_cast<const Int*>(node)->val)); break;
+			case NodeKind::Char: put(static_cast<const Char*>(node)->val); break;
+			case NodeKind::String: put(static_cast<const ast::String*>(node)->val); break;
+			case NodeKind::Future: put(static_cast<const Future*>(node)->generated); break;
+			case NodeKind::Tuple: put(static_cast<const Tuple*>(node)->elems); break;
+			case NodeKind::Array: put(static_cast<const Array*>(node)->elems); break;
+			case NodeKind::Block: put(static_cast<const Block*>(node)->elems); break;
+			case NodeKind::Function: {
+				auto& n = static_cast<const Function&>(*node);
+				put(n.args);
+				put(n.body);
+				break;
+			}
+			case NodeKind::BasicBinding: {
+				auto& n = static_cast<const BasicBinding&>(*node);
+				put(n.name);
+				put(n.type);
+				break;
+			}
+			case NodeKind::PathPart: {
+				auto& n = static_cast<const PathPart&>(*node);
+				put(n.name);
+				put(n.type);
+				put(n.gens);
+				break;
+			}
+			case NodeKind::Path: put(static_cast<const Path*>(node)->elems); break;
+			case NodeKind::TuplePattern: put(static_cast<const TuplePattern*>(node)->elems); break;
+			case NodeKind::VarPattern: put(static_cast<const VarPattern*>(node)->name); break;
+			case NodeKind::AdtPattern: {
+				auto& n = static_cast<const AdtPattern&>(*node);
+				put(n.name);
+				put(n.args);
+				break;
+			}
+			case NodeKind::ValPattern: put(static_cast<const ValPattern*>(node)->val); break;
+			case NodeKind::AssignName: put(static_cast<const AssignName*>(node)->var); break;
+			case NodeKind::AssignTuple: put(static_cast<const AssignTuple*>(node)->elems); break;
+			case NodeKind::SourceType: put(static_cast<const SourceType*>(node)->name); break;
+			case NodeKind::GenericType: {
+				auto& n = static_cast<const GenericType&>(*node);
+				put(n.name);
+				put(n.inst);
+				break;
+			}
+			case NodeKind::TupleType: put(static_cast<const TupleType*>(node)->elems); break;
+			case NodeKind::FunctionType: {
+				auto& n = static_cast<const FunctionType&>(*node);
+				put(n.args);
+				put(n.ret);
+				break;
+			}
+			case NodeKind::AndType: put(static_cast<const AndType*>(node)->elems); break;
+			case NodeKind::OrType: put(static_cast<const OrType*>(node)->elems); break;
+			case NodeKind::Annotation:
+			case NodeKind::LocalAnnotation: {
+				auto& n = static_cast<const Annotation&>(*node);
+				put(n.name);
+				put(n.args);
+				break;
+			}
+			case NodeKind::GenericPart: {
+				auto& n = static_cast<const GenericPart&>(*node);
+				put(n.name);
+				put(n.type);
+				put(n.rel);
+				break;
+			}
+			case NodeKind::TypeGeneric: {
+				auto& n = static_cast<const TypeGeneric&>(*node);
+				put(n.name);
+				put(n.type);
+				put(n.rel);
+				put(n.variance);
+				put(n.variadic);
+				put(n.default_type);
+				break;
+			}
+			case NodeKind::ValueGeneric: {
+				auto& n = static_cast<const ValueGeneric&>(*node);
+				put(n.name);
+				put(n.type);
+				put(n.rel);
+				put(n.default_val);
+				break;
+			}
+			case NodeKind::LitGeneric: put(static_cast<const LitGeneric*>(node)->value); break;
+			case NodeKind::GenericArray: put(static_cast<const GenericArray*>(node)->elems); break;
+			case NodeKind::Adt: {
+				auto& n = static_cast<const Adt&>(*node);
+				put(n.name);
+				put(n.args);
+				break;
+			}
+			case NodeKind::TypeAnnotation: {
+				auto& n = static_cast<const TypeAnnotation&>(*node);
+				put(n.expression);
+				put(n.typ);
+				break;
+			}
+			case NodeKind::Argument: {
+				auto& n = static_cast<const Argument&>(*node);
+				put(n.name);
+				put(n.typ);
+				break;
+			}
+			case NodeKind::ArgTuple: put(static_cast<const ArgTuple*>(node)->elems); break;
+			case NodeKind::Loop: put(static_cast<const Loop*>(node)->body); break;
+			case NodeKind::While: {
+				auto& n = static_cast<const While&>(*node);
+				put(n.test);
+				put(n.body);
+				break;
+			}
+			case NodeKind::For: {
+				auto& n = static_cast<const For&>(*node);
+				put(n.pattern);
+				put(n.generator);
+				put(n.body);
+				break;
+			}
+			case NodeKind::IfBranch: {
+				auto& n = static_cast<const IfBranch&>(*node);
+				put(n.test);
+				put(n.body);
+				put(n.elsif);
+				break;
+			}
+			case NodeKind::IfElse: {
+				auto& n = static_cast<const IfElse&>(*node);
+				put(n.elems);
+				put(n.else_);
+				break;
+			}
+			case NodeKind::Case: {
+				auto& n = static_cast<const Case&>(*node);
+				put(n.vars);
+				put(n.if_guard);
+				put(n.expr);
+				break;
+			}
+			case NodeKind::Match: {
+				auto& n = static_cast<const Match&>(*node);
+				put(n.switch_expr);
+				put(n.cases);
+				break;
+			}
+			case NodeKind::Jump: {
+				auto& n = static_cast<const Jump&>(*node);
+				put(n.type);
+				put(n.expr);
+				break;
+			}
+			case NodeKind::ModDec: put(static_cast<const ModDec*>(node)->_module); break;
+			case NodeKind::ImplExpr: {
+				auto& n = static_cast<const ImplExpr&>(*node);
+				put(n.type);
+				put(n._interface);
+				put(n.impls);
+				break;
+			}
+			case NodeKind::SingleImport: put(static_cast<const SingleImport*>(node)->_module); break;
+			case NodeKind::MultipleImport: {
+				auto& n = static_cast<const MultipleImport&>(*node);
+				put(n._module);
+				put(n.elems);
+				break;
+			}
+			case NodeKind::Rebind: {
+				auto& n = static_cast<const Rebind&>(*node);
+				put(n._module);
+				put(n.new_name);
+				break;
+			}
+			case NodeKind::Interface: {
+				auto& n = static_cast<const Interface&>(*node);
+				put(n.vis);
+				put(n.name);
+				put(n.gen);
+				put(n.type);
+				break;
+			}
+			case NodeKind::TypeAssign: {
+				auto& n = static_cast<const TypeAssign&>(*node);
+				put(n.vis);
+				put(n.name);
+				put(n.gen);
+				put(n.mutable_only);
+				put(n.cons);
+				put(n.body);
+				break;
+			}
+			case NodeKind::VarAssign: {
+				auto& n = static_cast<const VarAssign&>(*node);
+				put(n.vis);
+				put(n.name);
+				put(n.gen);
+				put(n.type);
+				put(n.expr);
+				break;
+			}
+			case NodeKind::TypeExtension: {
+				auto& n = static_cast<const TypeExtension&>(*node);
+				put(n.typ_name);
+				put(n.args);
+				put(n.ext);
+				break;
+			}
+			case NodeKind::InAssign: {
+				auto& n = static_cast<const InAssign&>(*node);
+				put(n.bind);
+				put(n.expr);
+				break;
+			}
+			case NodeKind::Variable: put(static_cast<const Variable*>(node)->name); break;
+			case NodeKind::UnOpCall: {
+				auto& n = static_cast<const UnOpCall&>(*node);
+				put(n.expr);
+				put(n.op);
+				break;
+			}
+			case NodeKind::BinOpCall: {
+				auto& n = static_cast<const BinOpCall&>(*node);
+				put(n.lhs);
+				put(n.rhs);
+				put(n.op);
+				break;
+			}
+			case NodeKind::Index: put(static_cast<const Index*>(node)->elems); break;
+			case NodeKind::FnCall: {
+				auto& n = static_cast<const FnCall&>(*node);
+				put(n.callee);
+				put(n.arguments);
+				break;
+			}
+			case NodeKind::Symbol: put(static_cast<const ast::Symbol*>(node)->ch); break;
+
+			// Nodes without any fields of their own
+			default:
+				break;
+		}
+
+		putTail(*node);
+	}
+
+	std::string serialize(const Stack& stack) {
+		AstWriter writer;
+		for (auto& node : stack) {
+			writer.put(node);
+		}
+
+		return writer.finish(static_cast<uint32_t>(stack.size()));
+	}
+
+
+	//
+	// Reading
+	//
+	class AstReader {
+		const char* curr;
+		const char* end;
+		std::vector<std::string_view> strings;
+
+		template<class T>
+		T raw() {
+			T val{};
+			if (static_cast<size_t>(end - curr) < sizeof(T)) {
+				ok = false;
+				return val;
+			}
+
+			std::memcpy(&val, curr, sizeof(T));
+			curr += sizeof(T);
+			return val;
+		}
+
+		std::string_view str() {
+			auto id = raw<uint32_t>();
+			if (id >= strings.size()) {
+				ok = false;
+				return {};
+			}
+			return strings[id];
+		}
+
+		public:
+			bool ok = true;
+
+			AstReader(std::string_view bytes) : curr{ bytes.data() }, end{ bytes.data() + bytes.size() } {}
+
+			bool readStrings(uint32_t count) {
+				strings.reserve(count);
+				while (ok && count--) {
+					auto size = raw<uint32_t>();
+					if (static_cast<size_t>(end - curr) < size) {
+						return ok = false;
+					}
+
+					strings.emplace_back(curr, size);
+					curr += size;
+				}
+
+				return ok;
+			}
+
+			template<class T>
+			std::enable_if_t<std::is_arithmetic_v<T>, T> get() { return raw<T>(); }
+			template<class E>
+			auto get() -> decltype(E::_from_integral(0)) {
+				auto val = raw<typename E::_integral>();
+				if (!E::_is_valid(val)) {
+					ok = false;
+					return E::_values()[0];
+				}
+				return E::_from_integral(val);
+			}
+
+			spero::String name() { return intern(str()); }
+			std::string text() { return std::string{ str() }; }
+			Location loc() {
+				auto line = get<uint32_t>();
+				auto byte = get<uint32_t>();
+				return Location{ line, byte, text() };
+			}
+
+			ptr<Ast> node();
+
+			// Read a child node that has to have the given type (or be null)
+			template<class N>
+			ptr<N> child() {
+				auto n = node();
+				if (n && !dynamic_cast<N*>(n.get())) {
+					ok = false;
+					return nullptr;
+				}
+				return util::dynCast<N>(std::move(n));
+			}
+			template<class N>
+			std::deque<ptr<N>> seq() {
+				std::deque<ptr<N>> ret;
+				for (auto size = get<uint32_t>(); ok && size; --size) {
+					ret.push_back(child<N>());
+				}
+				return ret;
+			}
+
+			void getTail(Ast& node) {
+				if (auto* stmt = dynamic_cast<Statement*>(&node)) {
+					stmt->annots = seq<LocalAnnotation>();
+				}
+				if (auto* val = dynamic_cast<ValExpr*>(&node)) {
+					val->is_mut = get<bool>();
+				}
+				if (auto* pat = dynamic_cast<Pattern*>(&node)) {
+					pat->cap = get<CaptureType>();
+				}
+				if (auto* pat = dynamic_cast<AssignPattern*>(&node)) {
+					pat->is_mut = get<bool>();
+				}
+				if (auto* typ = dynamic_cast<ast::Type*>(&node)) {
+					typ->is_mut = get<bool>();
+				}
+				if (auto* typ = dynamic_cast<SourceType*>(&node)) {
+					typ->_ptr = get<PtrStyling>();
+				}
+			}
+	};
+
+	template<size_t I = 0>
+	static ptr<Ast> readToken(AstReader& in, size_t index, Location loc) {
+		using token_type = ast::Token::token_type;
+
+		if constexpr (I == std::variant_size_v<token_type>) {
+			in.ok = false;
+			return nullptr;
+		} else if (index == I) {
+			return std::make_unique<ast::Token>(in.get<std::variant_alternative_t<I, token_type>>(), std::move(loc));
+		} else {
+			return readToken<I + 1>(in, index, std::move(loc));
+		}
+	}
+
+	// Restore the mutability of an assignment's binding, which the `Interface` constructors overwrite
+	template<class N>
+	static ptr<N> keepBindingMut(ptr<N> node, bool is_mut) {
+		if (node->name) {
+			node->name->is_mut = is_mut;
+		}
+		return node;
+	}
+
+	ptr<Ast> AstReader::node() {
+		auto kind = raw<NodeKind>();
+		if (!ok || kind == NodeKind::Null) {
+			return nullptr;
+		}
+		if (kind >= NodeKind::NumKinds) {
+			ok = false;
+			return nullptr;
+		}
+
+		auto l = loc();
+		ptr<Ast> ret;
+
+		switch (kind) {
+			case NodeKind::Ast: ret = std::make_unique<Ast>(l); break;
+			case NodeKind::Token: {
+				auto index = get<uint8_t>();
+				ret = readToken(*this, index, l);
+				break;
+			}
+			case NodeKind::Type: ret = std::make_unique<ast::Type>(l); break;
+			case NodeKind::Statement: ret = std::make_unique<Statement>(l); break;
+			case NodeKind::ValExpr: ret = std::make_unique<ValExpr>(l); break;
+			case NodeKind::Bool: ret = std::make_unique<Bool>(get<bool>(), l); break;
+			case NodeKind::Byte: ret = std::make_unique<Byte>(static_cast<unsigned long>(get<uint64_t>()), l); break;
+			case NodeKind::Float: ret = std::make_unique<Float>(get<double>(), l); break;
+			case NodeKind::Int: ret = std::make_unique<Int>(static_cast<long>(get<int64_t>()), l); break;
+			case NodeKind::Char: ret = std::make_unique<Char>(get<char>(), l); break;
+			case NodeKind::String: ret = std::make_unique<ast::String>(text(), l); break;
+			case NodeKind::Future: ret = std::make_unique<Future>(get<bool>(), l); break;
+			case NodeKind::Tuple: ret = std::make_unique<Tuple>(seq<ValExpr>(), l); break;
+			case NodeKind::Array: ret = std::make_unique<Array>(seq<ValExpr>(), l); break;
+			case NodeKind::Block: ret = std::make_unique<Block>(seq<Statement>(), l); break;
+			case NodeKind::Function: {
+				auto args = seq<Argument>();
+				auto body = child<Block>();
+				ret = std::make_unique<Function>(std::move(args), std::move(body), l);
+				break;
+			}
+			case NodeKind::BasicBinding: {
+				auto str = name();
+				ret = std::make_unique<BasicBinding>(str, get<BindingType>(), l);
+				break;
+			}
+			case NodeKind::PathPart: {
+				auto str = name();
+				auto part = std::make_unique<PathPart>(str, get<BindingType>(), l);
+				part->gens = child<Array>();
+				ret = std::move(part);
+				break;
+			}
+			case NodeKind::Path: {
+				auto path = std::make_unique<Path>(nullptr, l);
+				path->elems = seq<PathPart>();
+				ret = std::move(path);
+				break;
+			}
+			case NodeKind::Pattern: ret = std::make_unique<Pattern>(l); break;
+			case NodeKind::TuplePattern: ret = std::make_unique<TuplePattern>(seq<Pattern>(), l); break;
+			case NodeKind::VarPattern: ret = std::make_unique<VarPattern>(child<Path>(), l); break;
+			case NodeKind::AdtPattern: {
+				auto adt_name = child<Path>();
+				auto args = child<TuplePattern>();
+				ret = std::make_unique<AdtPattern>(std::move(adt_name), std::move(args), l);
+				break;
+			}
+			case NodeKind::ValPattern: ret = std::make_unique<ValPattern>(child<ValExpr>(), l); break;
+			case NodeKind::AssignPattern: ret = std::make_unique<AssignPattern>(l); break;
+			case NodeKind::AssignName: ret = std::make_unique<AssignName>(child<BasicBinding>(), l); break;
+			case NodeKind::AssignTuple: ret = std::make_unique<AssignTuple>(seq<AssignPattern>(), l); break;
+			case NodeKind::SourceType: ret = std::make_unique<SourceType>(child<Path>(), l); break;
+			case NodeKind::GenericType: {
+				auto binding = child<Path>();
+				auto inst = child<Array>();
+				ret = std::make_unique<GenericType>(std::move(binding), std::move(inst), l);
+				break;
+			}
+			case NodeKind::TupleType: ret = std::make_unique<TupleType>(seq<ast::Type>(), l); break;
+			case NodeKind::FunctionType: {
+				auto args = child<TupleType>();
+				auto ret_type = child<ast::Type>();
+				ret = std::make_unique<FunctionType>(std::move(args), std::move(ret_type), l);
+				break;
+			}
+			case NodeKind::AndType: {
+				auto typ = std::make_unique<AndType>(nullptr, l);
+				typ->elems = seq<ast::Type>();
+				ret = std::move(typ);
+				break;
+			}
+			case NodeKind::OrType: {
+				auto typ = std::make_unique<OrType>(nullptr, l);
+				typ->elems = seq<ast::Type>();
+				ret = std::move(typ);
+				break;
+			}
+			case NodeKind::Annotation:
+			case NodeKind::LocalAnnotation: {
+				auto annot_name = child<BasicBinding>();
+				auto args = child<Tuple>();
+				if (kind == NodeKind::Annotation) {
+					ret = std::make_unique<Annotation>(std::move(annot_name), std::move(args), l);
+				} else {
+					ret = std::make_unique<LocalAnnotation>(std::move(annot_name), std::move(args), l);
+				}
+				break;
+			}
+			case NodeKind::GenericPart: {
+				auto binding = child<BasicBinding>();
+				auto typ = child<ast::Type>();
+				ret = std::make_unique<GenericPart>(std::move(binding), std::move(typ), get<RelationType>(), l);
+				break;
+			}
+			case NodeKind::TypeGeneric: {
+				auto binding = child<BasicBinding>();
+				auto typ = child<ast::Type>();
+				auto rel = get<RelationType>();
+				auto variance = get<VarianceType>();
+				auto variadic = get<bool>();
+				auto gen = std::make_unique<TypeGeneric>(std::move(binding), std::move(typ), rel, variance, variadic, l);
+				gen->default_type = child<ast::Type>();
+				ret = std::move(gen);
+				break;
+			}
+			case NodeKind::ValueGeneric: {
+				auto binding = child<BasicBinding>();
+				auto typ = child<ast::Type>();
+				auto gen = std::make_unique<ValueGeneric>(std::move(binding), std::move(typ), get<RelationType>(), l);
+				gen->default_val = child<ValExpr>();
+				ret = std::move(gen);
+				break;
+			}
+			case NodeKind::LitGeneric: ret = std::make_unique<LitGeneric>(child<ValExpr>(), l); break;
+			case NodeKind::GenericArray: ret = std::make_unique<GenericArray>(seq<GenericPart>(), l); break;
+			case NodeKind::Adt: {
+				auto type_name = child<BasicBinding>();
+				auto args = child<TupleType>();
+				ret = std::make_unique<Adt>(std::move(type_name), std::move(args), l);
+				break;
+			}
+			case NodeKind::TypeAnnotation: {
+				auto expression = child<ValExpr>();
+				auto typ = child<ast::Type>();
+				ret = std::make_unique<TypeAnnotation>(std::move(expression), std::move(typ), l);
+				break;
+			}
+			case NodeKind::Argument: {
+				auto binding = child<BasicBinding>();
+				auto typ = child<ast::Type>();
+				ret = std::make_unique<Argument>(std::move(binding), std::move(typ), l);
+				break;
+			}
+			case NodeKind::ArgTuple: ret = std::make_unique<ArgTuple>(seq<Argument>(), l); break;
+			case NodeKind::Branch: ret = std::make_unique<Branch>(l); break;
+			case NodeKind::Loop: ret = std::make_unique<Loop>(child<ValExpr>(), l); break;
+			case NodeKind::While: {
+				auto test = child<ValExpr>();
+				auto body = child<ValExpr>();
+				ret = std::make_unique<While>(std::move(test), std::move(body), l);
+				break;
+			}
+			case NodeKind::For: {
+				auto pattern = child<Pattern>();
+				auto generator = child<ValExpr>();
+				auto body = child<ValExpr>();
+				ret = std::make_unique<For>(std::move(pattern), std::move(generator), std::move(body), l);
+				break;
+			}
+			case NodeKind::IfBranch: {
+				auto test = child<ValExpr>();
+				auto body = child<ValExpr>();
+				ret = std::make_unique<IfBranch>(std::move(test), std::move(body), get<bool>(), l);
+				break;
+			}
+			case NodeKind::IfElse: {
+				auto ifs = seq<IfBranch>();
+				auto else_ = child<ValExpr>();
+				ret = std::make_unique<IfElse>(std::move(ifs), std::move(else_), l);
+				break;
+			}
+			case NodeKind::Case: {
+				auto vars = child<TuplePattern>();
+				auto guard = child<ValExpr>();
+				auto expr = child<ValExpr>();
+				ret = std::make_unique<Case>(std::move(vars), std::move(guard), std::move(expr), l);
+				break;
+			}
+			case NodeKind::Match: {
+				auto test = child<ValExpr>();
+				auto cases = seq<Case>();
+				ret = std::make_unique<Match>(std::move(test), std::move(cases), l);
+				break;
+			}
+			case NodeKind::Jump: {
+				auto type = get<KeywordType>();
+				ret = std::make_unique<Jump>(type, child<ValExpr>(), l);
+				break;
+			}
+			case NodeKind::ModDec: ret = std::make_unique<ModDec>(child<Path>(), l); break;
+			case NodeKind::ImplExpr: {
+				auto import_type = child<SourceType>();
+				auto impl_type = child<SourceType>();
+				auto impls = child<Block>();
+				ret = std::make_unique<ImplExpr>(std::move(import_type), std::move(impl_type), std::move(impls), l);
+				break;
+			}
+			case NodeKind::SingleImport: ret = std::make_unique<SingleImport>(child<Path>(), l); break;
+			case NodeKind::MultipleImport: {
+				auto mod = child<Path>();
+				auto names = seq<PathPart>();
+				ret = std::make_unique<MultipleImport>(std::move(mod), std::move(names), l);
+				break;
+			}
+			case NodeKind::Rebind: {
+				auto mod = child<Path>();
+				auto new_name = child<Path>();
+				ret = std::make_unique<Rebind>(std::move(mod), std::move(new_name), l);
+				break;
+			}
+			case NodeKind::Interface: {
+				auto vis = get<VisibilityType>();
+				auto binding = child<AssignPattern>();
+				auto gen = child<GenericArray>();
+				auto type = child<ast::Type>();
+				if (!binding) {
+					ok = false;
+					break;
+				}
+
+				auto is_mut = binding->is_mut;
+				ret = keepBindingMut(std::make_unique<Interface>(vis, std::move(binding), std::move(gen), std::move(type), l), is_mut);
+				break;
+			}
+			case NodeKind::TypeAssign: {
+				auto vis = get<VisibilityType>();
+				auto binding = child<AssignPattern>();
+				auto gen = child<GenericArray>();
+				auto mut_only = get<bool>();
+				auto cons = seq<Constructor>();
+				auto body = child<Block>();
+				if (!binding || !body) {
+					ok = false;
+					break;
+				}
+
+				auto is_mut = binding->is_mut;
+				ret = keepBindingMut(std::make_unique<TypeAssign>(vis, std::move(binding), std::move(gen), mut_only, std::move(cons), std::move(body), l), is_mut);
+				break;
+			}
+			case NodeKind::VarAssign: {
+				auto vis = get<VisibilityType>();
+				auto binding = child<AssignPattern>();
+				auto gen = child<GenericArray>();
+				auto type = child<ast::Type>();
+				auto expr = child<ValExpr>();
+				if (!binding || !expr) {
+					ok = false;
+					break;
+				}
+
+				auto is_mut = binding->is_mut;
+				ret = keepBindingMut(std::make_unique<VarAssign>(vis, std::move(binding), std::move(gen), std::move(type), std::move(expr), l), is_mut);
+				break;
+			}
+			case NodeKind::TypeExtension: {
+				auto base_type = child<Path>();
+				auto base_args = child<Tuple>();
+				auto ext = child<Block>();
+				ret = std::make_unique<TypeExtension>(std::move(base_type), std::move(base_args), std::move(ext), l);
+				break;
+			}
+			case NodeKind::InAssign: {
+				auto bind = child<VarAssign>();
+				auto expr = child<ValExpr>();
+				ret = std::make_unique<InAssign>(std::move(bind), std::move(expr), l);
+				break;
+			}
+			case NodeKind::Variable: ret = std::make_unique<Variable>(child<Path>(), l); break;
+			case NodeKind::UnOpCall: {
+				auto expr = child<ValExpr>();
+				auto op = child<BasicBinding>();
+				ret = std::make_unique<UnOpCall>(std::move(expr), std::move(op), l);
+				break;
+			}
+			case NodeKind::BinOpCall: {
+				auto lhs = child<ValExpr>();
+				auto rhs = child<ValExpr>();
+				ret = std::make_unique<BinOpCall>(std::move(lhs), std::move(rhs), name(), l);
+				break;
+			}
+			case NodeKind::Index: ret = std::make_unique<Index>(seq<ValExpr>(), l); break;
+			case NodeKind::FnCall: {
+				auto callee = child<ValExpr>();
+				auto arguments = child<Tuple>();
+				ret = std::make_unique<FnCall>(std::move(callee), std::move(arguments), l);
+				break;
+			}
+			case NodeKind::Symbol: ret = std::make_unique<ast::Symbol>(get<char>(), l); break;
+			case NodeKind::Error: ret = std::make_unique<Error>(l); break;
+			case NodeKind::CloseSymbolError: ret = std::make_unique<CloseSymbolError>(l); break;
+			case NodeKind::ValError: ret = std::make_unique<ValError>(l); break;
+			case NodeKind::TypeError: ret = std::make_unique<TypeError>(l); break;
+			case NodeKind::ScopeError: ret = std::make_unique<ScopeError>(l); break;
+			default:
+				ok = false;
+				break;
+		}
+
+		if (!ok || !ret) {
+			ok = false;
+			return nullptr;
+		}
+
+		getTail(*ret);
+		return ret;
+	}
+
+	bool isSerializedAst(std::string_view bytes) {
+		return bytes.size() >= header_size && bytes.substr(0, sizeof(magic)) == std::string_view{ magic, sizeof(magic) };
+	}
+
+	bool deserialize(std::string_view bytes, Stack& stack) {
+		if (!isSerializedAst(bytes)) {
+			return false;
+		}
+
+		AstReader in{ bytes.substr(sizeof(magic)) };
+		if (in.get<uint32_t>() != version || in.get<uint32_t>() != byte_order) {
+			return false;
+		}
+
+		auto num_strings = in.get<uint32_t>();
+		auto num_roots = in.get<uint32_t>();
+		if (!in.readStrings(num_strings)) {
+			return false;
+		}
+
+		Stack nodes;
+		while (in.ok && num_roots--) {
+			nodes.push_back(in.node());
+		}
+
+		if (!in.ok) {
+			return false;
+		}
+
+		std::move(nodes.begin(), nodes.end(), std::back_inserter(stack));
+		return true;
+	}
+
+#undef SPERO_AST_NODES
+
+}
@@ -0,0 +1,139 @@
+#include "spero_string.h"
+
+namespace spero::string {
+
+	namespace detail {
+		const Entry well_known[NUM_WELL_KNOWN] = {
+			{ "", hashOf(""), EMPTY },
+			{ "self", hashOf("self"), SELF },
+			{ "super", hashOf("super"), SUPER },
+			{ "Int", hashOf("Int"), INT },
+			{ "Bool", hashOf("Bool"), BOOL },
+			{ "Float", hashOf("Float"), FLOAT },
+			{ "Char", hashOf("Char"), CHAR },
+			{ "Byte", hashOf("Byte"), BYTE },
+			{ "String", hashOf("String"), STRING },
+			{ "=", hashOf("="), ASSIGN },
+			{ "main", hashOf("main"), MAIN },
+			{ "jitfunc", hashOf("jitfunc"), JITFUNC }
+		};
+	}
+
+
+	//
+	// Interner
+	//
+	std::atomic<id_type> Interner::next_id{ NUM_WELL_KNOWN };
+
+	Interner::Table::Table(std::size_t capacity)
+		: mask{ capacity - 1 }, slots{ new std::atomic<const Entry*>[capacity] }
+	{
+		for (std::size_t i = 0; i != capacity; ++i) {
+			slots[i].store(nullptr, std::memory_order_relaxed);
+		}
+	}
+
+	Interner::Interner() {
+		for (auto& shard : shards) {
+			shard.table.store(&shard.tables.emplace_back(initial_capacity), std::memory_order_release);
+		}
+
+		for (auto& entry : detail::well_known) {
+			seed(entry);
+		}
+	}
+
+	// NOTE: The low bits of the hash select the shard, so probing starts from the high bits
+	const Entry* Interner::find(const Table& table, std::string_view str, std::size_t hash) {
+		for (auto i = (hash >> 4) & table.mask; ; i = (i + 1) & table.mask) {
+			auto* entry = table.slots[i].load(std::memory_order_acquire);
+
+			if (!entry) {
+				return nullptr;
+			}
+			if (entry->hash == hash && entry->str == str) {
+				return entry;
+			}
+		}
+	}
+	void Interner::insert(Table& table, const Entry* entry) {
+		auto i = (entry->hash >> 4) & table.mask;
+		while (table.slots[i].load(std::memory_order_relaxed)) {
+			i = (i + 1) & table.mask;
+		}
+
+		table.slots[i].store(entry, std::memory_order_release);
+	}
+	void Interner::seed(const Entry& entry) {
+		auto& shard = shards[entry.hash % num_shards];
+		insert(*shard.table.load(std::memory_order_relaxed), &entry);
+		++shard.count;
+	}
+
+	const Entry& Interner::intern(std::string_view str) {
+		auto hash = hashOf(str);
+		auto& shard = shards[hash % num_shards];
+
+		// Fast path: the name already exists
+		if (auto* entry = find(*shard.table.load(std::memory_order_acquire), str, hash)) {
+			return *entry;
+		}
+
+		std::lock_guard<std::mutex> lock{ shard.insert_lock };
+		auto* table = shard.table.load(std::memory_order_relaxed);
+
+		// Another thread may have inserted the name while we were waiting
+		if (auto* entry = find(*table, str, hash)) {
+			return *entry;
+		}
+
+		// Keep the load factor under 1/2. The old table is retired, not freed, as readers may still be probing it
+		if ((shard.count + 1) * 2 > table->mask + 1) {
+			auto& grown = shard.tables.emplace_back((table->mask + 1) * 2);
+			for (std::size_t i = 0; i <= table->mask; ++i) {
+				if (auto* entry = table->slots[i].load(std::memory_order_relaxed)) {
+					insert(grown, entry);
+				}
+			}
+
+			shard.table.store(&grown, std::memory_order_release);
+			table = &grown;
+		}
+
+		auto& entry = shard.entries.emplace_back(Entry{ backing_type{ str }, hash, next_id.fetch_add(1, std::memory_order_relaxed), this });
+		insert(*table, &entry);
+		++shard.count;
+		count.fetch_add(1, std::memory_order_relaxed);
+
+		return entry;
+	}
+
+	std::size_t Interner::size() const {
+		return count.load(std::memory_order_relaxed);
+	}
+
+
+	//
+	// Current interner
+	//
+	namespace {
+		thread_local Interner* current_interner = nullptr;
+	}
+
+	Interner& current() {
+		if (current_interner) {
+			return *current_interner;
+		}
+
+		static Interner process_interner;
+		return process_interner;
+	}
+
+	InternerScope::InternerScope(Interner& interner) : prev{ current_interner } {
+		current_interner = &interner;
+	}
+	InternerScope::~InternerScope() {
+		current_interner = prev;
+	}
+
+}
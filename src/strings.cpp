@@ -24,8 +24,8 @@ namespace spero::util {
 		return std::move(ret);
 	}
 
-	std::string escape(std::string str) {
-		return str;
+	std::string escape(std::string_view str) {
+		return std::string{ str };
 	}
 
 }
\ No newline at end of file
@@ -0,0 +1,61 @@
+#include "analysis/types.h"
+
+namespace spero::analysis {
+
+	size_t Type::Hash::operator()(const Type& t) const {
+		auto combine = [](size_t seed, size_t val) {
+			return seed ^ (val + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+		};
+
+		size_t seed = combine(t.type_kind._to_integral(), std::hash<String>{}(t.type_name));
+		seed = combine(seed, t.is_mutable);
+		for (auto* part : t.components) {
+			seed = combine(seed, std::hash<const Type*>{}(part));
+		}
+
+		return seed;
+	}
+	bool Type::Equal::operator()(const Type& lhs, const Type& rhs) const {
+		return lhs.type_kind == rhs.type_kind
+			&& lhs.is_mutable == rhs.is_mutable
+			&& lhs.type_name == rhs.type_name
+			&& lhs.components == rhs.components;
+	}
+
+
+	const Type* TypeInterner::intern(TypeKind kind, String name, std::vector<const Type*> parts, bool mut) {
+		// Elements of an `unordered_set` are never moved, so the address is stable for the lifetime of the interner
+		return &*types.insert(Type{ kind, name, std::move(parts), mut }).first;
+	}
+
+	const Type* TypeInterner::named(const String& name) {
+		return intern(TypeKind::NAMED, name, {});
+	}
+	const Type* TypeInterner::generic(const String& name, std::vector<const Type*> args) {
+		return intern(TypeKind::GENERIC, name, std::move(args));
+	}
+	const Type* TypeInterner::tuple(std::vector<const Type*> elems) {
+		return intern(TypeKind::TUPLE, string::names::empty, std::move(elems));
+	}
+	const Type* TypeInterner::function(std::vector<const Type*> args, const Type* ret) {
+		args.push_back(ret);
+		return intern(TypeKind::FUNCTION, string::names::empty, std::move(args));
+	}
+	const Type* TypeInterner::array(const Type* elem) {
+		return intern(TypeKind::ARRAY, string::names::empty, { elem });
+	}
+
+	const Type* TypeInterner::pointer(const Type* pointee) {
+		return intern(TypeKind::POINTER, string::names::empty, { pointee });
+	}
+	const Type* TypeInterner::reference(const Type* pointee) {
+		return intern(TypeKind::REFERENCE, string::names::empty, { pointee });
+	}
+	const Type* TypeInterner::view(const Type* pointee) {
+		return intern(TypeKind::VIEW, string::names::empty, { pointee });
+	}
+	const Type* TypeInterner::mut(const Type* type) {
+		return intern(type->kind(), type->name(), type->parts(), true);
+	}
+
+}